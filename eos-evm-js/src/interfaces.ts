@@ -30,6 +30,7 @@ export interface EvmReceipt {
   r: string
   s: string
   createdAddress: string
+  cumulativeGasUsed: number
   gasUsed: number
   gasLimit: number
   gasPrice: number
@@ -37,6 +38,7 @@ export interface EvmReceipt {
   output: string
   errors: string[]
   transactionHash: string
+  transactionIndex: number
 }
 
 export interface EvmResponse {
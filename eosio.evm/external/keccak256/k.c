@@ -19,149 +19,121 @@
 
 #include "k.h"
 
+/* rate of keccak-256 in bytes, 17 lanes */
 #define BLOCK_SIZE     ((1600 - 256 * 2) / 8)
+#define BLOCK_LANES    (BLOCK_SIZE / 8)
 
-#define I64(x) x##LL
 #define ROTL64(qword, n) ((qword) << (n) ^ ((qword) >> (64 - (n))))
-#define le2me_64(x) (x)
-#define IS_ALIGNED_64(p) (0 == (7 & ((const char*)(p) - (const char*)0)))
-#define me64_to_le_str(to, from, length) memcpy((to), (from), (length))
 
-/* constants */
-
-//const uint8_t round_constant_info[] PROGMEM = {
-//const uint8_t constants[] PROGMEM = {
-const uint8_t constants[]  = {
-
-    1, 26, 94, 112, 31, 33, 121, 85, 14, 12, 53, 38, 63, 79, 93, 83, 82, 72, 22, 102, 121, 88, 33, 116,
-//};
-
-//const uint8_t pi_transform[] PROGMEM = {
-    1, 6, 9, 22, 14, 20, 2, 12, 13, 19, 23, 15, 4, 24, 21, 8, 16, 5, 3, 18, 17, 11, 7, 10,
-//};
-
-//const uint8_t rhoTransforms[] PROGMEM = {
-    1, 62, 28, 27, 36, 44, 6, 55, 20, 3, 10, 43, 25, 39, 41, 45, 15, 21, 8, 18, 2, 61, 56, 14,
+static const uint64_t round_constants[24] = {
+    0x0000000000000001ULL, 0x0000000000008082ULL, 0x800000000000808AULL,
+    0x8000000080008000ULL, 0x000000000000808BULL, 0x0000000080000001ULL,
+    0x8000000080008081ULL, 0x8000000000008009ULL, 0x000000000000008AULL,
+    0x0000000000000088ULL, 0x0000000080008009ULL, 0x000000008000000AULL,
+    0x000000008000808BULL, 0x800000000000008BULL, 0x8000000000008089ULL,
+    0x8000000000008003ULL, 0x8000000000008002ULL, 0x8000000000000080ULL,
+    0x000000000000800AULL, 0x800000008000000AULL, 0x8000000080008081ULL,
+    0x8000000000008080ULL, 0x0000000080000001ULL, 0x8000000080008008ULL
 };
 
-#define TYPE_ROUND_INFO      0
-#define TYPE_PI_TRANSFORM   24
-#define TYPE_RHO_TRANSFORM  48
-
-inline uint8_t getConstant(uint8_t type, uint8_t index) {
-    return constants[type + index];
-    //return pgm_read_byte(&constants[type + index]);
-}
-
-static inline uint64_t get_round_constant(uint8_t round) {
-    uint64_t result = 0;
-
-    //uint8_t roundInfo = pgm_read_byte(&round_constant_info[round]);
-    uint8_t roundInfo = getConstant(TYPE_ROUND_INFO, round);
-    if (roundInfo & (1 << 6)) { result |= ((uint64_t)1 << 63); }
-    if (roundInfo & (1 << 5)) { result |= ((uint64_t)1 << 31); }
-    if (roundInfo & (1 << 4)) { result |= ((uint64_t)1 << 15); }
-    if (roundInfo & (1 << 3)) { result |= ((uint64_t)1 << 7); }
-    if (roundInfo & (1 << 2)) { result |= ((uint64_t)1 << 3); }
-    if (roundInfo & (1 << 1)) { result |= ((uint64_t)1 << 1); }
-    if (roundInfo & (1 << 0)) { result |= ((uint64_t)1 << 0); }
-
-    return result;
-}
-
-
-/* Initializing a sha3 context for given number of output bits */
-inline void keccak_init(SHA3_CTX *ctx) {
-    /* NB: The Keccak capacity parameter = bits * 2 */
-
-    memset(ctx, 0, sizeof(SHA3_CTX));
-}
-
-/* Keccak theta() transformation */
-inline static void keccak_theta(uint64_t *A) {
-    uint64_t C[5], D[5];
-
-    for (uint8_t i = 0; i < 5; i++) {
-        C[i] = A[i];
-        for (uint8_t j = 5; j < 25; j += 5) { C[i] ^= A[i + j]; }
-    }
-
-    for (uint8_t i = 0; i < 5; i++) {
-        D[i] = ROTL64(C[(i + 1) % 5], 1) ^ C[(i + 4) % 5];
-    }
-
-    for (uint8_t i = 0; i < 5; i++) {
-        //for (uint8_t j = 0; j < 25; j += 5) {
-        for (uint8_t j = 0; j < 25; j += 5) { A[i + j] ^= D[i]; }
-    }
-}
-
-
-/* Keccak pi() transformation */
-inline static void keccak_pi(uint64_t *A) {
-    uint64_t A1 = A[1];
-    //for (uint8_t i = 1; i < sizeof(pi_transform); i++) {
-    for (uint8_t i = 1; i < 24; i++) {
-        //A[pgm_read_byte(&pi_transform[i - 1])] = A[pgm_read_byte(&pi_transform[i])];
-        A[getConstant(TYPE_PI_TRANSFORM, i - 1)] = A[getConstant(TYPE_PI_TRANSFORM, i)];
-    }
-    A[10] = A1;
-    /* note: A[ 0] is left as is */
+/* Lanes are little endian, as is wasm */
+static inline uint64_t load_lane(const unsigned char* p) {
+    uint64_t lane;
+    memcpy(&lane, p, 8);
+    return lane;
 }
 
-/*
-ketch uses 30084 bytes (93%) of program storage space. Maximum is 32256 bytes.
-Global variables use 743 bytes (36%) of dynamic memory, leaving 1305 bytes for local variables. Maximum is 2048 bytes.
-*/
-/* Keccak chi() transformation */
-inline static void keccak_chi(uint64_t *A) {
-    for (uint8_t i = 0; i < 25; i += 5) {
-        uint64_t A0 = A[0 + i], A1 = A[1 + i];
-        A[0 + i] ^= ~A1 & A[2 + i];
-        A[1 + i] ^= ~A[2 + i] & A[3 + i];
-        A[2 + i] ^= ~A[3 + i] & A[4 + i];
-        A[3 + i] ^= ~A[4 + i] & A0;
-        A[4 + i] ^= ~A0 & A1;
-    }
-}
+/* Keccak-f[1600], each round unrolled over the 25 lanes */
+static inline void sha3_permutation(uint64_t *A) {
+    uint64_t B[25];
+    uint64_t C0, C1, C2, C3, C4;
+    uint64_t D0, D1, D2, D3, D4;
 
-inline static void sha3_permutation(uint64_t *state) {
-    //for (uint8_t round = 0; round < sizeof(round_constant_info); round++) {
     for (uint8_t round = 0; round < 24; round++) {
-        keccak_theta(state);
-
-        /* apply Keccak rho() transformation */
-        for (uint8_t i = 1; i < 25; i++) {
-            //state[i] = ROTL64(state[i], pgm_read_byte(&rhoTransforms[i - 1]));
-            state[i] = ROTL64(state[i], getConstant(TYPE_RHO_TRANSFORM, i - 1));
-        }
-
-        keccak_pi(state);
-        keccak_chi(state);
-
-        /* apply iota(state, round) */
-        *state ^= get_round_constant(round);
+        /* theta */
+        C0 = A[0] ^ A[5] ^ A[10] ^ A[15] ^ A[20];
+        C1 = A[1] ^ A[6] ^ A[11] ^ A[16] ^ A[21];
+        C2 = A[2] ^ A[7] ^ A[12] ^ A[17] ^ A[22];
+        C3 = A[3] ^ A[8] ^ A[13] ^ A[18] ^ A[23];
+        C4 = A[4] ^ A[9] ^ A[14] ^ A[19] ^ A[24];
+        D0 = C4 ^ ROTL64(C1, 1);
+        D1 = C0 ^ ROTL64(C2, 1);
+        D2 = C1 ^ ROTL64(C3, 1);
+        D3 = C2 ^ ROTL64(C4, 1);
+        D4 = C3 ^ ROTL64(C0, 1);
+
+        /* theta applied while loading, then rho and pi: B[y][2x + 3y] = ROTL(A[x][y], r[x][y]) */
+        B[ 0] = A[0] ^ D0;
+        B[10] = ROTL64(A[1] ^ D1, 1);
+        B[20] = ROTL64(A[2] ^ D2, 62);
+        B[ 5] = ROTL64(A[3] ^ D3, 28);
+        B[15] = ROTL64(A[4] ^ D4, 27);
+        B[16] = ROTL64(A[5] ^ D0, 36);
+        B[ 1] = ROTL64(A[6] ^ D1, 44);
+        B[11] = ROTL64(A[7] ^ D2, 6);
+        B[21] = ROTL64(A[8] ^ D3, 55);
+        B[ 6] = ROTL64(A[9] ^ D4, 20);
+        B[ 7] = ROTL64(A[10] ^ D0, 3);
+        B[17] = ROTL64(A[11] ^ D1, 10);
+        B[ 2] = ROTL64(A[12] ^ D2, 43);
+        B[12] = ROTL64(A[13] ^ D3, 25);
+        B[22] = ROTL64(A[14] ^ D4, 39);
+        B[23] = ROTL64(A[15] ^ D0, 41);
+        B[ 8] = ROTL64(A[16] ^ D1, 45);
+        B[18] = ROTL64(A[17] ^ D2, 15);
+        B[ 3] = ROTL64(A[18] ^ D3, 21);
+        B[13] = ROTL64(A[19] ^ D4, 8);
+        B[14] = ROTL64(A[20] ^ D0, 18);
+        B[24] = ROTL64(A[21] ^ D1, 2);
+        B[ 9] = ROTL64(A[22] ^ D2, 61);
+        B[19] = ROTL64(A[23] ^ D3, 56);
+        B[ 4] = ROTL64(A[24] ^ D4, 14);
+
+        /* chi */
+        A[ 0] = B[ 0] ^ (~B[ 1] & B[ 2]);
+        A[ 1] = B[ 1] ^ (~B[ 2] & B[ 3]);
+        A[ 2] = B[ 2] ^ (~B[ 3] & B[ 4]);
+        A[ 3] = B[ 3] ^ (~B[ 4] & B[ 0]);
+        A[ 4] = B[ 4] ^ (~B[ 0] & B[ 1]);
+        A[ 5] = B[ 5] ^ (~B[ 6] & B[ 7]);
+        A[ 6] = B[ 6] ^ (~B[ 7] & B[ 8]);
+        A[ 7] = B[ 7] ^ (~B[ 8] & B[ 9]);
+        A[ 8] = B[ 8] ^ (~B[ 9] & B[ 5]);
+        A[ 9] = B[ 9] ^ (~B[ 5] & B[ 6]);
+        A[10] = B[10] ^ (~B[11] & B[12]);
+        A[11] = B[11] ^ (~B[12] & B[13]);
+        A[12] = B[12] ^ (~B[13] & B[14]);
+        A[13] = B[13] ^ (~B[14] & B[10]);
+        A[14] = B[14] ^ (~B[10] & B[11]);
+        A[15] = B[15] ^ (~B[16] & B[17]);
+        A[16] = B[16] ^ (~B[17] & B[18]);
+        A[17] = B[17] ^ (~B[18] & B[19]);
+        A[18] = B[18] ^ (~B[19] & B[15]);
+        A[19] = B[19] ^ (~B[15] & B[16]);
+        A[20] = B[20] ^ (~B[21] & B[22]);
+        A[21] = B[21] ^ (~B[22] & B[23]);
+        A[22] = B[22] ^ (~B[23] & B[24]);
+        A[23] = B[23] ^ (~B[24] & B[20]);
+        A[24] = B[24] ^ (~B[20] & B[21]);
+
+        /* iota */
+        A[0] ^= round_constants[round];
     }
 }
 
-/**
- * The core transformation. Process the specified block of data.
- *
- * @param hash the algorithm state
- * @param block the message block to process
- * @param block_size the size of the processed block in bytes
- */
-inline static void sha3_process_block(uint64_t hash[25], const uint64_t *block) {
-    for (uint8_t i = 0; i < 17; i++) {
-        hash[i] ^= le2me_64(block[i]);
+/* XOR a full block into the state and permute */
+static inline void sha3_absorb_block(uint64_t hash[25], const unsigned char *block) {
+    for (uint8_t i = 0; i < BLOCK_LANES; i++) {
+        hash[i] ^= load_lane(block + 8 * i);
     }
 
-    /* make a permutation of the hash */
     sha3_permutation(hash);
 }
 
-//#define SHA3_FINALIZED 0x80000000
-//#define SHA3_FINALIZED 0x8000
+/* Initializing a sha3 context */
+inline void keccak_init(SHA3_CTX *ctx) {
+    memset(ctx, 0, sizeof(SHA3_CTX));
+}
 
 /**
  * Calculate message hash.
@@ -171,36 +143,26 @@ inline static void sha3_process_block(uint64_t hash[25], const uint64_t *block)
  * @param msg message chunk
  * @param size length of the message chunk
  */
-inline void keccak_update(SHA3_CTX *ctx, const unsigned char *msg, uint16_t size)
+inline void keccak_update(SHA3_CTX *ctx, const unsigned char *msg, size_t size)
 {
-    uint16_t idx = (uint16_t)ctx->rest;
-
-    //if (ctx->rest & SHA3_FINALIZED) return; /* too late for additional input */
-    ctx->rest = (unsigned)((ctx->rest + size) % BLOCK_SIZE);
+    size_t idx = ctx->rest;
+    ctx->rest = (ctx->rest + size) % BLOCK_SIZE;
 
     /* fill partial block */
     if (idx) {
-        uint16_t left = BLOCK_SIZE - idx;
+        size_t left = BLOCK_SIZE - idx;
         memcpy((char*)ctx->message + idx, msg, (size < left ? size : left));
         if (size < left) return;
 
         /* process partial block */
-        sha3_process_block(ctx->hash, ctx->message);
+        sha3_absorb_block(ctx->hash, (const unsigned char*)ctx->message);
         msg  += left;
         size -= left;
     }
 
+    /* full blocks are absorbed from the input without copying */
     while (size >= BLOCK_SIZE) {
-        uint64_t* aligned_message_block;
-        if (IS_ALIGNED_64(msg)) {
-            // the most common case is processing of an already aligned message without copying it
-            aligned_message_block = (uint64_t*)(void*)msg;
-        } else {
-            memcpy(ctx->message, msg, BLOCK_SIZE);
-            aligned_message_block = ctx->message;
-        }
-
-        sha3_process_block(ctx->hash, aligned_message_block);
+        sha3_absorb_block(ctx->hash, msg);
         msg  += BLOCK_SIZE;
         size -= BLOCK_SIZE;
     }
@@ -218,20 +180,41 @@ inline void keccak_update(SHA3_CTX *ctx, const unsigned char *msg, uint16_t size
 */
 inline void keccak_final(SHA3_CTX *ctx, unsigned char* result)
 {
-    uint16_t digest_length = 100 - BLOCK_SIZE / 2;
-
-//    if (!(ctx->rest & SHA3_FINALIZED)) {
-        /* clear the rest of the data queue */
-        memset((char*)ctx->message + ctx->rest, 0, BLOCK_SIZE - ctx->rest);
-        ((char*)ctx->message)[ctx->rest] |= 0x01;
-        ((char*)ctx->message)[BLOCK_SIZE - 1] |= 0x80;
+    /* clear the rest of the data queue and pad */
+    memset((char*)ctx->message + ctx->rest, 0, BLOCK_SIZE - ctx->rest);
+    ((char*)ctx->message)[ctx->rest] |= 0x01;
+    ((char*)ctx->message)[BLOCK_SIZE - 1] |= 0x80;
 
-        /* process final block */
-        sha3_process_block(ctx->hash, ctx->message);
-//        ctx->rest = SHA3_FINALIZED; /* mark context as finalized */
-//    }
+    /* process final block */
+    sha3_absorb_block(ctx->hash, (const unsigned char*)ctx->message);
 
     if (result) {
-         me64_to_le_str(result, ctx->hash, digest_length);
+        memcpy(result, ctx->hash, 32);
     }
-}
\ No newline at end of file
+}
+
+/* One shot hash of a whole number of lanes shorter than a block, absorbed straight into the state */
+static inline void keccak_256_lanes(const unsigned char *msg, uint8_t lanes, unsigned char* result)
+{
+    uint64_t hash[25] = {};
+    for (uint8_t i = 0; i < lanes; i++) {
+        hash[i] = load_lane(msg + 8 * i);
+    }
+    hash[lanes] ^= 0x01;
+    hash[BLOCK_LANES - 1] ^= 0x8000000000000000ULL;
+
+    sha3_permutation(hash);
+    memcpy(result, hash, 32);
+}
+
+/* A single word, e.g. Solidity array slots */
+inline void keccak_256_32(const unsigned char *msg, unsigned char* result)
+{
+    keccak_256_lanes(msg, 4, result);
+}
+
+/* Two words, e.g. Solidity mapping slots keccak(key . slot) */
+inline void keccak_256_64(const unsigned char *msg, unsigned char* result)
+{
+    keccak_256_lanes(msg, 8, result);
+}
@@ -31,9 +31,7 @@ typedef struct SHA3_CTX {
     /* 1536-bit buffer for leftovers */
     uint64_t message[sha3_max_rate_in_qwords];
     /* count of bytes in the message[] buffer */
-    uint16_t rest;
-    /* size of a message block processed at once */
-    //unsigned block_size;
+    size_t rest;
 } SHA3_CTX;
 
 
@@ -43,8 +41,10 @@ extern "C" {
 
 
 void keccak_init(SHA3_CTX *ctx);
-void keccak_update(SHA3_CTX *ctx, const unsigned char *msg, uint16_t size);
+void keccak_update(SHA3_CTX *ctx, const unsigned char *msg, size_t size);
 void keccak_final(SHA3_CTX *ctx, unsigned char* result);
+void keccak_256_32(const unsigned char *msg, unsigned char* result);
+void keccak_256_64(const unsigned char *msg, unsigned char* result);
 
 
 #ifdef __cplusplus
@@ -14,454 +14,235 @@ enum RLP_constants {
 };
 
 namespace rlp {
-    // Forward declaration
-    class RLPValue;
-    extern const RLPValue& NullRLPValue;
+    // Byte string form of an encoded field, integers are big endian without leading zeros
+    // Not copyable, integer fields point into their own scratch space
+    struct Field {
+        uint8_t scratch[32];
+        const uint8_t* data;
+        size_t size;
 
-    class RLPValue {
-    public:
-        enum VType { VARR, VBUF, };
-
-        std::vector<unsigned char> value;
-        std::vector<RLPValue> values;
-        VType typ = VBUF;
-
-        RLPValue() {}
-        ~RLPValue() {}
-
-        std::string get_value() const { return std::string((const char *) &value[0], value.size()); }
-        inline void clear() { typ = VBUF; value.clear(); values.clear(); }
-        inline bool set_array() { clear(); typ = VARR; return true; }
-
-        inline void prefix_multiple_length(size_t total_length, std::vector<uint8_t>& bs)
-        {
-            // "If the total payload of a list (i.e. the combined length of all its
-            // items being RLP encoded) is 0-55 bytes long
-            if (total_length <= 55) {
-                bs.insert(bs.begin(), 0xc0 + total_length);
-                return;
-            }
-
-            // "If the total payload of a list is more than 55 bytes long
-            auto total_length_as_bytes = to_byte_string(total_length);
-            const uint8_t length_of_total_length = total_length_as_bytes.size();
-
-            total_length_as_bytes.insert(total_length_as_bytes.begin(), 0xf7 + length_of_total_length);
-            bs.insert(bs.begin(), total_length_as_bytes.begin(), total_length_as_bytes.end());
-        }
-
-        inline std::vector<uint8_t> to_byte_string(const std::vector<uint8_t>& bs)
-        {
-            return bs;
-        }
-
-        inline std::vector<uint8_t> to_byte_string(const std::string& s)
-        {
-            return std::vector<uint8_t>(s.begin(), s.end());
-        }
+        Field(const std::vector<uint8_t>& v) : data(v.data()), size(v.size()) {}
+        Field(const std::string& s) : data((const uint8_t*) s.data()), size(s.size()) {}
 
         template <size_t N>
-        std::vector<uint8_t> to_byte_string(const std::array<uint8_t, N>& a)
-        {
-            return std::vector<uint8_t>(a.begin(), a.end());
-        }
+        Field(const std::array<uint8_t, N>& a) : data(a.data()), size(N) {}
 
-        template <typename T, size_t N>
-        std::vector<uint8_t> to_byte_string(const std::array<T, N>& a)
+        Field(const uint256_t& n)
         {
-            std::vector<uint8_t> combined;
-
-            for (const auto& e : a) {
-                const auto next = encode_single(e);
-                combined.insert(combined.end(), next.begin(), next.end());
-            }
-
-            prefix_multiple_length(combined.size(), combined);
-
-            return combined;
+            // 0 is the empty string, not a single 0 byte
+            intx::be::unsafe::store(scratch, n);
+            size = n == 0 ? 0 : intx::count_significant_words<uint8_t>(n);
+            data = scratch + 32 - size;
         }
 
-        template <typename T>
-        std::vector<uint8_t> to_byte_string(const std::vector<T>& v)
-        {
-            std::vector<uint8_t> combined;
-
-            for (const auto& e : v) {
-                const auto next = encode_single(e);
-                combined.insert(combined.end(), next.begin(), next.end());
-            }
+        Field(uint64_t n) : Field(uint256_t(n)) {}
 
-            prefix_multiple_length(combined.size(), combined);
+        Field(const Field&) = delete;
+        Field& operator=(const Field&) = delete;
+    };
 
-            return combined;
+    // Number of bytes of a length in long form
+    inline size_t length_of_length(size_t n)
+    {
+        size_t bytes = 0;
+        for (; n != 0; n >>= 8) {
+            bytes++;
         }
+        return bytes;
+    }
 
-        inline std::vector<uint8_t> to_byte_string(uint64_t n)
-        {
-            // "positive RLP integers must be represented in big endian binary form
-            // with no leading zeroes"
-            bool started = false;
+    inline size_t header_size(size_t payload_size)
+    {
+        return payload_size < 56 ? 1 : 1 + length_of_length(payload_size);
+    }
 
-            std::vector<uint8_t> bs;
-            for (size_t byte_index = 0; byte_index < sizeof(n); ++byte_index) {
-                const uint64_t offset = (7 - byte_index) * 8;
-                const uint64_t mask = (uint64_t)0xff << offset;
+    // "For a single byte whose value is in the [0x00, 0x7f] range, that byte is its own RLP encoding
+    inline bool is_single_byte(const Field& field)
+    {
+        return field.size == 1 && field.data[0] < RLP_bufferLenStart;
+    }
 
-                const uint8_t current_byte = (mask & n) >> offset;
+    inline size_t encoded_size(const Field& field)
+    {
+        return is_single_byte(field) ? 1 : header_size(field.size) + field.size;
+    }
 
-                if (started || current_byte != 0) {
-                    bs.push_back(current_byte);
-                    started = true;
-                }
-            }
+    // Sink is called with (const uint8_t* data, size_t size) for each run of output
+    template <typename Sink>
+    inline void write_header(Sink& sink, size_t payload_size, uint8_t offset)
+    {
+        uint8_t header[1 + RLP_maxUintLen];
 
-            // NB: If n is 0, this returns an empty list - this is correct.
-            return bs;
+        if (payload_size < 56) {
+            header[0] = offset + payload_size;
+            sink(header, 1);
+            return;
         }
 
-        inline std::vector<uint8_t> to_byte_string(const uint256_t& n)
-        {
-            std::vector<uint8_t> bs;
-
-            // Need to special-case 0 to return an empty list, not a list containing
-            // a single 0 byte
-            if (n != 0) {
-            // Get big-endian form
-                uint8_t arr[32] = {};
-                intx::be::store(arr, n);
-
-                // No leading zeroes - count signficant bytes
-                const auto n_bytes = intx::count_significant_words<uint8_t>(n);
-                bs.resize(n_bytes);
-
-                std::memcpy(bs.data(), arr + 32 - n_bytes, n_bytes);
-            }
-
-            return bs;
+        const auto bytes = length_of_length(payload_size);
+        header[0] = offset + 55 + bytes;
+        for (size_t i = bytes; i > 0; i--, payload_size >>= 8) {
+            header[i] = payload_size & 0xff;
         }
+        sink(header, 1 + bytes);
+    }
 
-        template <typename T>
-        inline void encode_single (T& item) {
-            RLPValue rlp;
-            auto bytes = to_byte_string(item);
-            rlp.value.assign(bytes.begin(), bytes.end());
-            values.push_back(rlp);
+    template <typename Sink>
+    inline void write_field(Sink& sink, const Field& field)
+    {
+        if (!is_single_byte(field)) {
+            write_header(sink, field.size, RLP_bufferLenStart);
         }
-
-        // Access by array
-        const RLPValue& operator[](size_t index) const
-        {
-            if (typ != VARR || index >= values.size()) {
-                return NullRLPValue;
-            } else {
-                return values.at(index);
-            }
+        if (field.size > 0) {
+            sink(field.data, field.size);
         }
+    }
 
-        std::string write() const
-        {
-            std::string s;
-            if (typ == VARR) {
-                writeArray(s);
-            } else if (typ == VBUF) {
-                writeBuffer(s);
-            }
-            return s;
-        }
+    // Encodes a single argument as a string and several as a list, sizes are computed
+    // first so output is written once, front to back
+    template <typename Sink, typename ... Args>
+    static void encode_to(Sink& sink, const Args& ... args)
+    {
+        const Field fields[] = { Field(args)... };
 
-        inline uint64_t toInteger(const unsigned char *raw, size_t len)
-        {
-            if (len == 0)
-                return 0;
-            else if (len == 1)
-                return *raw;
-            else
-                return (raw[len - 1]) + (toInteger(raw, len - 1) * 256);
+        if (sizeof...(Args) == 1) {
+            write_field(sink, fields[0]);
+            return;
         }
 
-        inline void writeBuffer(std::string& s) const
-        {
-            const unsigned char *p = value.size() ? &value[0] : nullptr;
-            size_t sz = value.size();
-
-            if ((sz == 1) && (p[0] < 0x80)) {
-                s.append((const char *) p, 1);
-            } else {
-                s += encodeLength(sz, 0x80) + get_value();
-            }
+        size_t payload_size = 0;
+        for (const auto& field : fields) {
+            payload_size += encoded_size(field);
         }
 
-        inline void writeArray(std::string& s) const
-        {
-            std::string tmp;
-            for (const RLPValue& value: values) {
-                tmp += value.write();
-            }
-            s += encodeLength(tmp.size(), 0xC0) + tmp;
+        write_header(sink, payload_size, RLP_listStart);
+        for (const auto& field : fields) {
+            write_field(sink, field);
         }
+    }
 
-        inline std::string encodeBinary(uint64_t n) const
-        {
-            // do nothing; return empty string
-            if (n == 0) return {};
-
-            // Encode
-            std::string rs;
-            rs.assign(encodeBinary(n / 256));
-            unsigned char ch = n % 256;
-            rs.append((const char *) &ch, 1);
-            return rs;
-        }
+    template <typename ... Args>
+    static std::string encode(const Args& ... args)
+    {
+        std::string out;
+        auto sink = [&](const uint8_t* data, size_t size) { out.append((const char*) data, size); };
+
+        // Exact size
+        size_t total = 0;
+        auto count = [&](const uint8_t*, size_t size) { total += size; };
+        encode_to(count, args...);
+
+        out.reserve(total);
+        encode_to(sink, args...);
+        return out;
+    }
 
-        inline std::string encodeLength(size_t n, unsigned char offset) const
-        {
-            std::string rs;
+    // Keccak 256 of the encoding, fed to the hash without materializing it
+    template <typename ... Args>
+    static std::array<uint8_t, 32> keccak(const Args& ... args)
+    {
+        SHA3_CTX context;
+        keccak_init(&context);
 
-            if (n < 56) {
-                unsigned char ch = n + offset;
-                rs.assign((const char *) &ch, 1);
-            } else {
-                // assert(n too big);
-                std::string binlen = encodeBinary(n);
+        auto sink = [&](const uint8_t* data, size_t size) { keccak_update(&context, data, size); };
+        encode_to(sink, args...);
 
-                unsigned char ch = binlen.size() + offset + 55;
-                rs.assign((const char *) &ch, 1);
-                rs.append(binlen);
-            }
+        std::array<uint8_t, 32> hash;
+        keccak_final(&context, hash.data());
+        return hash;
+    }
 
-            return rs;
-        }
+    // Non-owning view of an item inside an RLP encoded buffer
+    struct RLPItem {
+        const uint8_t* data = nullptr;
+        size_t size = 0;
+        bool is_list = false;
+    };
 
-        bool readArray(
-            const unsigned char *raw,
-            size_t len,
-            size_t uintlen,
-            size_t payloadlen,
-            size_t& consumed,
-            size_t& wanted
-        )
-        {
-            const size_t prefixlen = 1;
+    // Reads items of a buffer in place, rejecting non-canonical encodings
+    //  - single bytes below 0x80 must be encoded as themselves
+    //  - long lengths must be over 55 and have no leading zero bytes
+    //  - items must fit in the buffer
+    class RLPReader {
+    private:
+        const uint8_t* pos;
+        const uint8_t* end;
 
-            // validate list length, including possible addition overflows.
-            size_t expected = prefixlen + uintlen + payloadlen;
-            if ((expected > len) || (payloadlen > len)) {
-                wanted = expected > payloadlen ? expected : payloadlen;
+        // Big endian length of uintlen bytes, returns false if not canonical.
+        // Lengths are limited to 4 bytes so they cannot wrap a 32 bit size_t
+        inline bool read_length(size_t uintlen, size_t& length)
+        {
+            if (uintlen > sizeof(uint32_t) || static_cast<size_t>(end - pos) < uintlen || pos[0] == 0) {
                 return false;
             }
 
-            // we are type=array
-            set_array();
-
-            size_t child_len = payloadlen;
-            size_t child_wanted = 0;
-            size_t total_consumed = 0;
-
-            const unsigned char *list_ent = raw + prefixlen + uintlen;
-
-            // recursively read until payloadlen bytes parsed, or error
-            while (child_len > 0) {
-                RLPValue childVal;
-                size_t child_consumed = 0;
-
-                if (!childVal.read(list_ent, child_len, child_consumed, child_wanted))
-                    return false;
-
-                total_consumed += child_consumed;
-                list_ent       += child_consumed;
-                child_len      -= child_consumed;
-
-                values.push_back(childVal);
+            uint64_t value = 0;
+            for (size_t i = 0; i < uintlen; i++) {
+                value = (value << 8) | *pos++;
+            }
+            if (value <= 55 || value > static_cast<uint64_t>(end - pos)) {
+                return false;
             }
 
-            consumed = total_consumed;
+            length = static_cast<size_t>(value);
             return true;
         }
 
-        bool read(
-            const unsigned char *raw,
-            size_t len,
-            size_t& consumed,
-            size_t& wanted
-        )
-        {
-            clear();
-            consumed = 0;
-            wanted = 0;
-
-            std::vector<unsigned char> buf;
-            const unsigned char* end = raw + len;
-
-            const size_t prefixlen = 1;
+    public:
+        RLPReader(const uint8_t* data, size_t size) : pos(data), end(data + size) {}
+        RLPReader(const RLPItem& list) : pos(list.data), end(list.data + list.size) {}
 
-            unsigned char ch = *raw;
+        inline bool done() const { return pos == end; }
 
-            if (len < 1) {
-                wanted = 1;
-                goto out_fail;
+        // Reads the next item, returns false if there is none or it is malformed
+        bool next(RLPItem& item)
+        {
+            if (pos == end) {
+                return false;
             }
 
-            // Case 1: [prefix is 1-byte data buffer]
-            if (ch <= 0x7f) {
-                const unsigned char *tok_start = raw;
-                const unsigned char *tok_end = tok_start + prefixlen;
-                if (tok_end > end)
-                    goto out_fail;
-
-                // parsing done; assign data buffer value.
-                buf.assign(tok_start, tok_end);
-                value.assign(buf.begin(), buf.end());
-
-                consumed = buf.size();
-
-            // Case 2: [prefix, including buffer length][data]
-            } else if ((ch >= 0x80) && (ch <= 0xb7)) {
-                size_t blen = ch - 0x80;
-                size_t expected = prefixlen + blen;
-
-                if (len < expected) {
-                    wanted = expected;
-                    goto out_fail;
-                }
-
-                const unsigned char *tok_start = raw + 1;
-                const unsigned char *tok_end = tok_start + blen;
-
-                if (tok_end > end)
-                    goto out_fail;
-
-                // require minimal encoding
-                if ((blen == 1) && (tok_start[0] <= 0x7f))
-                    goto out_fail;
-
-                // parsing done; assign data buffer value.
-                buf.assign(tok_start, tok_end);
-                value.assign(buf.begin(), buf.end());
-
-                consumed = expected;
-
-            // Case 3: [prefix][buffer length][data]
-            } else if ((ch >= 0xb8) && (ch <= 0xbf)) {
-                size_t uintlen = ch - 0xb7;
-                size_t expected = prefixlen + uintlen;
-
-                if (len < expected) {
-                    wanted = expected;
-                    goto out_fail;
-                }
-
-                if (uintlen <= 0 || uintlen > RLP_maxUintLen)
-                    goto out_fail;
-
-                const unsigned char *tok_start = raw + prefixlen;
-                if ((uintlen > 1) && (tok_start[0] == 0))	// no leading zeroes
-                    goto out_fail;
-
-                // read buffer length
-                uint64_t slen = toInteger(tok_start, uintlen);
-
-                // validate buffer length, including possible addition overflows.
-                expected = prefixlen + uintlen + slen;
-                if (
-                    (slen < (RLP_listStart - RLP_bufferLenStart - RLP_maxUintLen)) ||
-                    (expected > len) || (slen > len)
-                ) {
-                    wanted = slen > expected ? slen : expected;
-                    goto out_fail;
-                }
-
-                // parsing done; assign data buffer value.
-                tok_start = raw + prefixlen + uintlen;
-                const unsigned char *tok_end = tok_start + slen;
-                buf.assign(tok_start, tok_end);
-                value.assign(buf.begin(), buf.end());
-
-                consumed = expected;
-
-            // Case 4: [prefix][list]
-            } else if ((ch >= 0xc0) && (ch <= 0xf7)) {
-                size_t payloadlen = ch - 0xc0;
-                size_t expected = prefixlen + payloadlen;
-                size_t list_consumed = 0;
-                size_t list_wanted = 0;
-
-                // read list payload
-                if (!readArray(raw, len, 0, payloadlen, list_consumed, list_wanted)) {
-                    wanted = list_wanted;
-                    goto out_fail;
-                }
-
-                if (list_consumed != payloadlen)
-                    goto out_fail;
-
-                consumed = expected;
-
-            // Case 5: [prefix][list length][list]
+            const uint8_t prefix = *pos++;
+            size_t length = 0;
+
+            if (prefix < RLP_bufferLenStart) {
+                item = { pos - 1, 1, false };
+                return true;
+            } else if (prefix <= 0xb7) {
+                length = prefix - RLP_bufferLenStart;
+                item.is_list = false;
+            } else if (prefix < RLP_listStart) {
+                if (!read_length(prefix - 0xb7, length)) return false;
+                item.is_list = false;
+            } else if (prefix <= 0xf7) {
+                length = prefix - RLP_listStart;
+                item.is_list = true;
             } else {
-                if (ch < 0xf8 || ch > 0xff)
-                    goto out_fail;
-
-                size_t uintlen = ch - 0xf7;
-                size_t expected = prefixlen + uintlen;
-
-                if (len < expected) {
-                    wanted = expected;
-                    goto out_fail;
-                }
-
-                if (uintlen <= 0 || uintlen > RLP_maxUintLen)
-                    goto out_fail;
-
-                const unsigned char *tok_start = raw + prefixlen;
-
-                if ((uintlen > 1) && (tok_start[0] == 0))	// no leading zeroes
-                    goto out_fail;
-
-                // read list length
-                size_t payloadlen = toInteger(tok_start, uintlen);
-
-            // special requirement for non-immediate length
-            if (payloadlen < (0x100 - RLP_listStart - RLP_maxUintLen))
-                goto out_fail;
-
-                size_t list_consumed = 0;
-                size_t list_wanted = 0;
-
-                // read list payload
-                if (!readArray(raw, len, uintlen, payloadlen, list_consumed, list_wanted)) {
-                    wanted = list_wanted;
-                    goto out_fail;
-                }
+                if (!read_length(prefix - 0xf7, length)) return false;
+                item.is_list = true;
+            }
 
-                if (list_consumed != payloadlen)
-                    goto out_fail;
+            if (length > static_cast<size_t>(end - pos)) {
+                return false;
+            }
 
-                consumed = prefixlen + uintlen + payloadlen;
+            // A single byte below 0x80 must not carry a prefix
+            if (!item.is_list && length == 1 && pos[0] < RLP_bufferLenStart) {
+                return false;
             }
 
+            item.data = pos;
+            item.size = length;
+            pos += length;
             return true;
-
-        out_fail:
-            clear();
-            return false;
         }
-    };
 
-    template <typename ... Args>
-    static std::string encode(Args&& ... args){
-        RLPValue rlp;
-        if (sizeof...(Args) > 1) {
-            rlp.set_array();
-        }
-        (rlp.encode_single(args), ...);
-        return rlp.write();
-    }
+        // Reads the next item as a byte string
+        inline bool next_bytes(RLPItem& item) { return next(item) && !item.is_list; }
 
-    static RLPValue decode(std::vector<int8_t> bytes){
-        RLPValue rlp;
-	    size_t consumed, wanted;
-    	bool valid = rlp.read((unsigned char *) bytes.data(), bytes.size(), consumed, wanted);
-        eosio::check(valid, "Invalid Transaction: RLP could not be decoded");
-        return rlp;
-    }
+        // Reads the next item as a scalar of at most max_size bytes without leading zeros
+        inline bool next_scalar(RLPItem& item, size_t max_size)
+        {
+            return next_bytes(item) && item.size <= max_size && (item.size == 0 || item.data[0] != 0);
+        }
+    };
 }
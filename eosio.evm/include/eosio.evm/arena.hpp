@@ -0,0 +1,178 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Copyright (c) 2020 Syed Jafri. All rights reserved.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdlib>
+
+namespace eosio_evm
+{
+  // Bump allocator owned by a single transaction
+  //
+  // Memory is taken from the system in chunks and handed out in order. Nothing is
+  // returned to the system before the arena is destroyed. Freeing the most recent
+  // allocation rewinds the cursor, any other freed block goes on a free list by
+  // size class and is split to serve later requests, so the buffers left behind by
+  // growing containers are reused instead of doubling the arena.
+  class Arena
+  {
+  private:
+    struct Chunk {
+      Chunk* next;
+    };
+
+    struct FreeBlock {
+      FreeBlock* next;
+      size_t size;
+    };
+
+    static constexpr size_t CHUNK_SIZE = 16 * 1024;
+    static constexpr size_t GRANULE    = alignof(std::max_align_t);
+    static constexpr size_t CLASSES    = 24;
+    static_assert(sizeof(FreeBlock) <= GRANULE, "free block header must fit a granule");
+
+    Chunk* head     = nullptr;
+    uint8_t* cursor = nullptr;
+    uint8_t* limit  = nullptr;
+    FreeBlock* free_blocks[CLASSES] = {}; // Class c holds blocks of at least GRANULE << c bytes
+
+    static inline size_t round_up(const size_t& size)
+    {
+      return (std::max<size_t>(size, 1) + GRANULE - 1) & ~(GRANULE - 1);
+    }
+
+    // Smallest class whose blocks all fit the size, CLASSES if none
+    static inline size_t fit_class(const size_t& size)
+    {
+      size_t c = 0;
+      while (c < CLASSES && (GRANULE << c) < size) c++;
+      return c;
+    }
+
+    // Class a block of this size belongs to
+    static inline size_t block_class(const size_t& size)
+    {
+      size_t c = 0;
+      while (c + 1 < CLASSES && (GRANULE << (c + 1)) <= size) c++;
+      return c;
+    }
+
+    inline void release(uint8_t* p, const size_t& size)
+    {
+      const auto c = block_class(size);
+      auto block = reinterpret_cast<FreeBlock*>(p);
+      block->next = free_blocks[c];
+      block->size = size;
+      free_blocks[c] = block;
+    }
+
+    static inline uint8_t* align_up(uint8_t* p, const size_t& align)
+    {
+      return reinterpret_cast<uint8_t*>((reinterpret_cast<uintptr_t>(p) + align - 1) & ~(uintptr_t)(align - 1));
+    }
+
+    // Requests larger than a chunk get a chunk of their own
+    void add_chunk(const size_t& size)
+    {
+      // Keep what is left of the current chunk
+      if (cursor != nullptr) {
+        auto tail = align_up(cursor, GRANULE);
+        if (tail + GRANULE <= limit) {
+          release(tail, (limit - tail) & ~(GRANULE - 1));
+        }
+      }
+
+      const auto chunk_size = std::max(CHUNK_SIZE, sizeof(Chunk) + size);
+      auto chunk = static_cast<Chunk*>(std::malloc(chunk_size));
+      eosio::check(chunk != nullptr, "arena out of memory");
+
+      chunk->next = head;
+      head   = chunk;
+      cursor = reinterpret_cast<uint8_t*>(chunk) + sizeof(Chunk);
+      limit  = reinterpret_cast<uint8_t*>(chunk) + chunk_size;
+    }
+
+  public:
+    Arena() = default;
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+
+    ~Arena()
+    {
+      while (head != nullptr) {
+        auto next = head->next;
+        std::free(head);
+        head = next;
+      }
+    }
+
+    // Sizes are rounded to GRANULE, alignments above GRANULE bypass the free lists
+    void* allocate(const size_t& size, const size_t& align)
+    {
+      const auto bytes = round_up(size);
+      if (align <= GRANULE) {
+        for (auto c = fit_class(bytes); c < CLASSES; c++) {
+          auto block = free_blocks[c];
+          if (block == nullptr) continue;
+
+          free_blocks[c] = block->next;
+          auto p = reinterpret_cast<uint8_t*>(block);
+          if (block->size - bytes >= GRANULE) {
+            release(p + bytes, block->size - bytes);
+          }
+          return p;
+        }
+      }
+
+      const auto block_align = std::max(align, GRANULE);
+      auto p = align_up(cursor, block_align);
+      if (cursor == nullptr || p + bytes > limit) {
+        add_chunk(bytes + block_align);
+        p = align_up(cursor, block_align);
+      }
+
+      cursor = p + bytes;
+      return p;
+    }
+
+    inline void deallocate(void* p, const size_t& size, const size_t& align)
+    {
+      const auto bytes = round_up(size);
+      if (static_cast<uint8_t*>(p) + bytes == cursor) {
+        cursor = static_cast<uint8_t*>(p);
+      } else if (align <= GRANULE) {
+        release(static_cast<uint8_t*>(p), bytes);
+      }
+    }
+  };
+
+  // Standard allocator drawing from an Arena, for containers that live as long as the transaction
+  template <typename T>
+  struct ArenaAllocator
+  {
+    using value_type = T;
+
+    Arena* arena;
+
+    explicit ArenaAllocator(Arena& arena) : arena(&arena) {}
+
+    template <typename U>
+    ArenaAllocator(const ArenaAllocator<U>& other) : arena(other.arena) {}
+
+    inline T* allocate(const size_t n) { return static_cast<T*>(arena->allocate(n * sizeof(T), alignof(T))); }
+    inline void deallocate(T* p, const size_t n) { arena->deallocate(p, n * sizeof(T), alignof(T)); }
+
+    template <typename U>
+    inline bool operator==(const ArenaAllocator<U>& other) const { return arena == other.arena; }
+    template <typename U>
+    inline bool operator!=(const ArenaAllocator<U>& other) const { return arena != other.arena; }
+  };
+
+  template <typename T>
+  using ArenaVector = std::vector<T, ArenaAllocator<T>>;
+
+  template <typename K, typename V>
+  using ArenaMap = std::map<K, V, std::less<K>, ArenaAllocator<std::pair<const K, V>>>;
+} // namespace eosio_evm
@@ -0,0 +1,40 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Copyright (c) 2020 Syed Jafri. All rights reserved.
+// Licensed under the MIT License.
+
+#pragma once
+
+namespace eosio_evm
+{
+  // Immutable bytes shared between contexts (calldata, return data)
+  //
+  // Copies only copy the reference, so data passed through nested calls,
+  // return data and the identity precompile is materialized once.
+  class SharedBytes
+  {
+  private:
+    std::shared_ptr<std::vector<uint8_t>> buffer;
+
+  public:
+    SharedBytes() = default;
+    SharedBytes(std::vector<uint8_t>&& bytes)
+      : buffer(bytes.empty() ? nullptr : std::make_shared<std::vector<uint8_t>>(std::move(bytes))) {}
+    SharedBytes(const uint8_t* begin, const uint8_t* end)
+      : SharedBytes(std::vector<uint8_t>(begin, end)) {}
+
+    inline const uint8_t* data() const { return buffer ? buffer->data() : nullptr; }
+    inline size_t size() const { return buffer ? buffer->size() : 0; }
+    inline bool empty() const { return size() == 0; }
+    inline const uint8_t* begin() const { return data(); }
+    inline const uint8_t* end() const { return data() + size(); }
+    inline const uint8_t& operator[](const size_t i) const { return (*buffer)[i]; }
+    inline std::vector<uint8_t> to_vector() const { return { begin(), end() }; }
+
+    // Moves the bytes out if no other copy shares them, copies otherwise. Leaves this empty
+    inline std::vector<uint8_t> release() {
+      auto bytes = buffer.use_count() == 1 ? std::move(*buffer) : to_vector();
+      buffer.reset();
+      return bytes;
+    }
+  };
+} // namespace eosio_evm
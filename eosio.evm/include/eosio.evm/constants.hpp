@@ -17,6 +17,10 @@
 #define PRINT_LOGS false // not really helpful on EOSIO, but kept for completeness.
 #define OPTRACE false
 #define PRINT_STATE false
+#define PRINT_STATS false // prints cache hit/miss counters after each transaction
+
+// Dispatch opcodes through a 256 entry handler table instead of a switch
+#define DISPATCH_TABLE false
 
 // Token constants
 #define TOKEN_SYMBOL_CODE_RAW "EOS"
@@ -4,17 +4,32 @@
 
 #pragma once
 
-#include <deque>
 #include "constants.hpp"
 #include "exception.hpp"
+#include "bytes.hpp"
+#include "memory.hpp"
 #include "program.hpp"
 #include "stack.hpp"
 
 namespace eosio_evm {
   class evm;
 
-  using SuccessHandler = std::function<void(const std::vector<uint8_t>&, const uint256_t&)>;
-  using ErrorHandler   = std::function<void(const Exception&, const std::vector<uint8_t>&, const uint256_t&)>;
+  // What the parent does with the result of a context, see Processor::resume
+  enum class FrameKind : uint8_t {
+    TOP_LEVEL, // Result is written to the transaction's ExecResult
+    CALL,      // Output is copied to the parent's memory
+    CREATE     // Output becomes the code of the created account
+  };
+
+  struct Continuation {
+    FrameKind kind;
+    ExecResult* result;    // TOP_LEVEL
+    uint64_t out_offset;   // CALL
+    uint64_t out_size;     // CALL
+    uint256_t gas_limit;   // CREATE
+    uint256_t old_refunds; // Refunds restored if the context fails
+    Address new_address;   // CREATE
+  };
 
   /**
    * execution context of a call
@@ -22,16 +37,16 @@ namespace eosio_evm {
   class Context
   {
   private:
-    uint64_t pc = 0;
-    bool pc_changed = true;
+    uint64_t ip = 0; // Index into prog->instructions
+    bool ip_changed = true;
 
-    using PcType = decltype(pc);
+    using IpType = decltype(ip);
 
   public:
-    std::vector<uint8_t> mem;
-    Stack s;
+    Memory& mem;
+    Stack& s;
     uint256_t gas_left;
-    std::vector<uint8_t> last_return_data;      // last returned data
+    SharedBytes last_return_data;               // last returned data
 
     const size_t sm_checkpoint;
     const Account& caller;
@@ -39,24 +54,26 @@ namespace eosio_evm {
     uint256_t gas_limit;
     const bool is_static;
     const uint256_t call_value;
-    const std::vector<uint8_t> input;
-    const Program prog;
-    SuccessHandler success_cb;
-    ErrorHandler error_cb;
+    const SharedBytes input;
+    const std::shared_ptr<const Program> prog;
+    const Continuation cont;
 
     ~Context() = default;
     Context(
+      Stack& s,
+      Memory& mem,
       const size_t sm_checkpoint,
       const Account& caller,
       const Account& callee,
       uint256_t gas_limit,
       const bool is_static,
       const uint256_t call_value,
-      std::vector<uint8_t>&& input,
-      Program&& prog,
-      SuccessHandler&& success_cb,
-      ErrorHandler&& error_cb
+      SharedBytes input,
+      std::shared_ptr<const Program> prog,
+      const Continuation& cont
     ) noexcept :
+      mem(mem),
+      s(s),
       sm_checkpoint(sm_checkpoint),
       caller(caller),
       callee(callee),
@@ -64,48 +81,56 @@ namespace eosio_evm {
       gas_left(gas_limit),
       is_static(is_static),
       call_value(call_value),
-      input(input),
-      prog(prog),
-      success_cb(success_cb),
-      error_cb(error_cb),
-      s(this)
+      input(std::move(input)),
+      prog(std::move(prog)),
+      cont(cont)
     {
-      // When the code is not empty, we reserve memory to speed up execution
-      if (!prog.code.empty()) {
-        mem.reserve(4096);
-      }
+      // Stack and memory are reused from a previous context at the same depth
+      this->s.clear();
+      this->mem.clear();
     }
 
-    inline auto get_used_mem() const { return (mem.size() + WORD_SIZE - 1) / WORD_SIZE;  }
+    inline auto get_used_mem() const { return mem.words(); }
     inline uint256_t gas_used() const { return gas_limit - gas_left; }
-    PcType get_pc() const { return pc; }
+    IpType get_ip() const { return ip; }
+    const Instruction& get_instr() const { return prog->instructions[ip]; }
+    uint64_t get_pc() const { return prog->instructions[ip].pc; }
 
-    void set_pc(const PcType pc_)
+    void set_ip(const IpType ip_)
     {
-      pc = pc_;
-      pc_changed = true;
+      ip = ip_;
+      ip_changed = true;
     }
 
-    /// increment the pc if it wasn't changed before
+    /// increment the ip if it wasn't changed before
     void step() {
-      if (pc_changed) {
-        pc_changed = false;
+      if (ip_changed) {
+        ip_changed = false;
       } else {
-        pc++;
+        ip++;
       }
     }
 
     #if (TESTING == true)
     void print() {
-      eosio::print("\nmemory\":",  bin2hex(mem));
+      eosio::print("\nmemory\":",  bin2hex(mem.to_vector()));
       eosio::print("\nstack\":",   s.as_array());
       eosio::print("\ncaller\":",  caller.by_address());
       eosio::print("\ncallee\":",  callee.by_address());
       eosio::print("\ngasLeft\":", intx::to_string(gas_left));
       eosio::print("\nIs Static\":", is_static);
-      eosio::print("\nInput\":", bin2hex(input));
-      eosio::print("\nCall Value\":", intx::to_string(call_value), "\n");
+      eosio::print("\nInput\":", bin2hex(input.to_vector()));
+      eosio::print("\nCall Value\":", intx::to_string(call_value));
+      eosio::print("\nFrame Kind\":", static_cast<uint8_t>(cont.kind), "\n");
     }
     #endif /* TESTING */
   };
+
+  // Storage of one call depth, reused by every context pushed at that depth
+  struct Frame
+  {
+    Stack s;
+    Memory mem;
+    std::optional<Context> ctx;
+  };
 }
\ No newline at end of file
@@ -35,11 +35,14 @@ namespace eosio_evm {
 
     evm( eosio::name receiver, eosio::name code, eosio::datastream<const char*> ds )
       : contract(receiver, code, ds),
-        _accounts(receiver, receiver.value) {}
+        _accounts(receiver, receiver.value),
+        _account_codes(receiver, receiver.value) {}
 
     ACTION raw      ( const eosio::name& ram_payer,
                       const std::vector<int8_t>& tx,
                       const std::optional<eosio::checksum160>& sender);
+    ACTION rawbatch ( const eosio::name& ram_payer,
+                      const std::vector<std::vector<int8_t>>& txs);
     ACTION create   ( const eosio::name& account,
                       const std::string& data);
     ACTION withdraw ( const eosio::name& to,
@@ -51,6 +54,13 @@ namespace eosio_evm {
                    const eosio::asset& quantity,
                    const std::string& memo );
 
+    // Moves code of accounts created before the code table into it
+    ACTION migratecode ( const uint64_t& start_index,
+                         const uint64_t& limit );
+
+    // Erases storage left behind by SELFDESTRUCT and CREATE2, callable by anyone
+    ACTION cleanstorage ( const uint64_t& limit );
+
     // Extra to match ethereum functionality (calls do not modify state and will always assert)
     ACTION call(
       const eosio::name& ram_payer,
@@ -62,37 +72,42 @@ namespace eosio_evm {
     using withdraw_action = eosio::action_wrapper<"withdraw"_n, &evm::withdraw>;
     using transfer_action = eosio::action_wrapper<"transfer"_n, &evm::transfer>;
 
-    // Define account table
+    // Define account and code tables
     account_table _accounts;
+    account_code_table _account_codes;
+
+    // Analysed code by account index, shared by the transactions of an action
+    std::map<uint64_t, std::shared_ptr<const Program>> _programs;
+
+    // Index for a new account row, fails once indexes no longer fit a storage scope
+    uint64_t next_account_index() {
+      const auto index = _accounts.available_primary_key();
+      eosio::check(index <= Account::MAX_INDEX, "no account indexes left for new EVM accounts.");
+      return index;
+    }
+
+    // Code table, rows are reference counted by the accounts using them
+    const std::vector<uint8_t>& get_code(const Account& account);
+    eosio::checksum256 add_code(const eosio::name& ram_payer, const std::vector<uint8_t>& code);
+    void release_code(const Account& account);
 
     #if (TESTING == true)
     ACTION teststatetx(const std::vector<int8_t>& tx, const Env& env);
     ACTION devnewstore(const eosio::checksum160& address, const std::string& key, const std::string value);
     ACTION devnewacct(const eosio::checksum160& address, const std::string balance, const std::vector<uint8_t> code, const uint64_t nonce, const eosio::name& account);
+    ACTION devinlinecode(const eosio::checksum160& address, const std::vector<uint8_t> code);
     ACTION printstate(const eosio::checksum160& address);
     ACTION printaccount(const eosio::checksum160& address);
     ACTION testtx(const std::vector<int8_t>& tx);
     ACTION printtx(const std::vector<int8_t>& tx);
-    ACTION clearall () {
-      require_auth(get_self());
-
-      account_table db(get_self(), get_self().value);
-      auto itr = db.end();
-      while(db.begin() != itr){
-        itr = db.erase(--itr);
-      }
-
-      for(int i = 0; i < 25; i++) {
-        account_state_table db2(get_self(), i);
-        auto itr = db2.end();
-        while(db2.begin() != itr){
-          itr = db2.erase(--itr);
-        }
-      }
-    }
+    ACTION clearall ();
+    void clear_scope(const uint64_t& scope);
     #endif
 
   private:
+    // Validates and runs a decoded transaction, charging the sender
+    void execute(EthereumTransaction& transaction, const std::optional<eosio::checksum160>& sender);
+
     // EOS Transfer
     void sub_balance (const eosio::name& user, const eosio::asset& quantity);
     void add_balance (const eosio::name& user, const eosio::asset& quantity);
@@ -0,0 +1,72 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Copyright (c) 2020 Syed Jafri. All rights reserved.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include "constants.hpp"
+#include "util.hpp"
+
+namespace eosio_evm
+{
+  // EVM memory of a context
+  //
+  // The logical size is a whole number of words and its gas cost is kept alongside it,
+  // so expansion only prices the new words. The buffer grows by doubling (at least a
+  // page) and everything past the logical size is kept zeroed, so expanding within
+  // the buffer needs no work and clearing only touches bytes that were in use.
+  class Memory
+  {
+  private:
+    std::vector<uint8_t> buffer;
+    uint64_t logical_size = 0;
+    uint64_t cost = 0;
+
+    static constexpr uint64_t PAGE_SIZE = 4096;
+
+  public:
+    // Total gas cost of a memory of the given number of words
+    static inline uint64_t cost_of(const uint64_t& words) { return 3 * words + words * words / 512; }
+
+    inline void clear()
+    {
+      if (logical_size != 0) {
+        std::memset(buffer.data(), 0, logical_size);
+      }
+      logical_size = 0;
+      cost = 0;
+    }
+
+    inline uint64_t size() const { return logical_size; }
+    inline uint64_t words() const { return logical_size / WORD_SIZE; }
+    inline bool empty() const { return logical_size == 0; }
+
+    // Gas to be charged to expand to new_words, which must not be smaller than words()
+    inline uint64_t expansion_cost(const uint64_t& new_words) const { return cost_of(new_words) - cost; }
+
+    // Sets the logical size to new_words, the caller has charged expansion_cost(new_words)
+    void expand(const uint64_t& new_words)
+    {
+      const auto new_size = new_words * WORD_SIZE;
+      if (new_size > buffer.size()) {
+        const auto rounded = (new_size + PAGE_SIZE - 1) / PAGE_SIZE * PAGE_SIZE;
+        buffer.resize(std::max<uint64_t>(rounded, buffer.size() * 2));
+      }
+
+      logical_size = new_size;
+      cost = cost_of(new_words);
+    }
+
+    inline uint8_t* data() { return buffer.data(); }
+    inline uint8_t* begin() { return buffer.data(); }
+    inline uint8_t* end() { return buffer.data() + logical_size; }
+    inline uint8_t& operator[](const uint64_t& i) { return buffer[i]; }
+
+    // Word and byte access, the range must have been made accessible first
+    inline uint256_t load_word(const uint64_t& offset) const { return intx::be::unsafe::load<uint256_t>(&buffer[offset]); }
+    inline void store_word(const uint64_t& offset, const uint256_t& word) { intx::be::unsafe::store(&buffer[offset], word); }
+    inline void store_byte(const uint64_t& offset, const uint8_t& byte) { buffer[offset] = byte; }
+
+    inline std::vector<uint8_t> to_vector() const { return { buffer.begin(), buffer.begin() + logical_size }; }
+  };
+} // namespace eosio_evm
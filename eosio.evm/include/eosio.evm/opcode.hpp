@@ -466,6 +466,302 @@ namespace eosio_evm
     };
   }
 
+  // Stack requirements per opcode: minimum stack height and net change in height
+  namespace OpStack {
+    struct Requirement {
+      uint8_t height;
+      int8_t change;
+    };
+
+    static constexpr Requirement by_code[256] = {
+      // 0s: Stop and Arithmetic Operations
+      /* STOP       */  { 0, 0 },
+      /* ADD        */  { 2, -1 },
+      /* MUL        */  { 2, -1 },
+      /* SUB        */  { 2, -1 },
+      /* DIV        */  { 2, -1 },
+      /* SDIV       */  { 2, -1 },
+      /* MOD        */  { 2, -1 },
+      /* SMOD       */  { 2, -1 },
+      /* ADDMOD     */  { 3, -2 },
+      /* MULMOD     */  { 3, -2 },
+      /* EXP        */  { 2, -1 },
+      /* SIGNEXTEND */  { 2, -1 },
+      /* NULL       */  { 0, 0 },
+      /* NULL       */  { 0, 0 },
+      /* NULL       */  { 0, 0 },
+      /* NULL       */  { 0, 0 },
+
+      // 10s: Comparison & Bitwise Logic Operations
+      /* LT     */  { 2, -1 },
+      /* GT     */  { 2, -1 },
+      /* SLT    */  { 2, -1 },
+      /* SGT    */  { 2, -1 },
+      /* EQ     */  { 2, -1 },
+      /* ISZERO */  { 1, 0 },
+      /* AND    */  { 2, -1 },
+      /* OR     */  { 2, -1 },
+      /* XOR    */  { 2, -1 },
+      /* NOT    */  { 1, 0 },
+      /* BYTE   */  { 2, -1 },
+      /* SHL    */  { 2, -1 },
+      /* SHR    */  { 2, -1 },
+      /* SAR    */  { 2, -1 },
+      /* NULL   */  { 0, 0 },
+      /* NULL   */  { 0, 0 },
+
+      // 20s: SHA3
+      /* SHA3 */  { 2, -1 },
+      /* NULL */  { 0, 0 },
+      /* NULL */  { 0, 0 },
+      /* NULL */  { 0, 0 },
+      /* NULL */  { 0, 0 },
+      /* NULL */  { 0, 0 },
+      /* NULL */  { 0, 0 },
+      /* NULL */  { 0, 0 },
+      /* NULL */  { 0, 0 },
+      /* NULL */  { 0, 0 },
+      /* NULL */  { 0, 0 },
+      /* NULL */  { 0, 0 },
+      /* NULL */  { 0, 0 },
+      /* NULL */  { 0, 0 },
+      /* NULL */  { 0, 0 },
+      /* NULL */  { 0, 0 },
+
+      // 30s: Environmental Information
+      /* ADDRESS        */  { 0, 1 },
+      /* BALANCE        */  { 1, 0 },
+      /* ORIGIN         */  { 0, 1 },
+      /* CALLER         */  { 0, 1 },
+      /* CALLVALUE      */  { 0, 1 },
+      /* CALLDATALOAD   */  { 1, 0 },
+      /* CALLDATASIZE   */  { 0, 1 },
+      /* CALLDATACOPY   */  { 3, -3 },
+      /* CODESIZE       */  { 0, 1 },
+      /* CODECOPY       */  { 3, -3 },
+      /* GASPRICE       */  { 0, 1 },
+      /* EXTCODESIZE    */  { 1, 0 },
+      /* EXTCODECOPY    */  { 4, -4 },
+      /* RETURNDATASIZE */  { 0, 1 },
+      /* RETURNDATACOPY */  { 3, -3 },
+      /* EXTCODEHASH    */  { 1, 0 },
+
+      // 40s: Block Information
+      /* BLOCKHASH   */  { 1, 0 },
+      /* COINBASE    */  { 0, 1 },
+      /* TIMESTAMP   */  { 0, 1 },
+      /* NUMBER      */  { 0, 1 },
+      /* DIFFICULTY  */  { 0, 1 },
+      /* GASLIMIT    */  { 0, 1 },
+      /* CHAINID     */  { 0, 1 },
+      /* SELFBALANCE */  { 0, 1 },
+      /* NULL        */  { 0, 0 },
+      /* NULL        */  { 0, 0 },
+      /* NULL        */  { 0, 0 },
+      /* NULL        */  { 0, 0 },
+      /* NULL        */  { 0, 0 },
+      /* NULL        */  { 0, 0 },
+      /* NULL        */  { 0, 0 },
+      /* NULL        */  { 0, 0 },
+
+      // 50s: Stack, Memory, Storage and Flow Operations
+      /* POP      */  { 1, -1 },
+      /* MLOAD    */  { 1, 0 },
+      /* MSTORE   */  { 2, -2 },
+      /* MSTORE8  */  { 2, -2 },
+      /* SLOAD    */  { 1, 0 },
+      /* SSTORE   */  { 2, -2 },
+      /* JUMP     */  { 1, -1 },
+      /* JUMPI    */  { 2, -2 },
+      /* PC       */  { 0, 1 },
+      /* MSIZE    */  { 0, 1 },
+      /* GAS      */  { 0, 1 },
+      /* JUMPDEST */  { 0, 0 },
+      /* NULL     */  { 0, 0 },
+      /* NULL     */  { 0, 0 },
+      /* NULL     */  { 0, 0 },
+      /* NULL     */  { 0, 0 },
+
+      // 60s & 70s: Push Operations
+      /* PUSH1  */  { 0, 1 },
+      /* PUSH2  */  { 0, 1 },
+      /* PUSH3  */  { 0, 1 },
+      /* PUSH4  */  { 0, 1 },
+      /* PUSH5  */  { 0, 1 },
+      /* PUSH6  */  { 0, 1 },
+      /* PUSH7  */  { 0, 1 },
+      /* PUSH8  */  { 0, 1 },
+      /* PUSH9  */  { 0, 1 },
+      /* PUSH10 */  { 0, 1 },
+      /* PUSH11 */  { 0, 1 },
+      /* PUSH12 */  { 0, 1 },
+      /* PUSH13 */  { 0, 1 },
+      /* PUSH14 */  { 0, 1 },
+      /* PUSH15 */  { 0, 1 },
+      /* PUSH16 */  { 0, 1 },
+      /* PUSH17 */  { 0, 1 },
+      /* PUSH18 */  { 0, 1 },
+      /* PUSH19 */  { 0, 1 },
+      /* PUSH20 */  { 0, 1 },
+      /* PUSH21 */  { 0, 1 },
+      /* PUSH22 */  { 0, 1 },
+      /* PUSH23 */  { 0, 1 },
+      /* PUSH24 */  { 0, 1 },
+      /* PUSH25 */  { 0, 1 },
+      /* PUSH26 */  { 0, 1 },
+      /* PUSH27 */  { 0, 1 },
+      /* PUSH28 */  { 0, 1 },
+      /* PUSH29 */  { 0, 1 },
+      /* PUSH30 */  { 0, 1 },
+      /* PUSH31 */  { 0, 1 },
+      /* PUSH32 */  { 0, 1 },
+
+      // 80s: Duplication Operation
+      /* DUP1  */  { 1, 1 },
+      /* DUP2  */  { 2, 1 },
+      /* DUP3  */  { 3, 1 },
+      /* DUP4  */  { 4, 1 },
+      /* DUP5  */  { 5, 1 },
+      /* DUP6  */  { 6, 1 },
+      /* DUP7  */  { 7, 1 },
+      /* DUP8  */  { 8, 1 },
+      /* DUP9  */  { 9, 1 },
+      /* DUP10 */  { 10, 1 },
+      /* DUP11 */  { 11, 1 },
+      /* DUP12 */  { 12, 1 },
+      /* DUP13 */  { 13, 1 },
+      /* DUP14 */  { 14, 1 },
+      /* DUP15 */  { 15, 1 },
+      /* DUP16 */  { 16, 1 },
+
+      // 90s: Exchange Operation
+      /* SWAP1  */  { 2, 0 },
+      /* SWAP2  */  { 3, 0 },
+      /* SWAP3  */  { 4, 0 },
+      /* SWAP4  */  { 5, 0 },
+      /* SWAP5  */  { 6, 0 },
+      /* SWAP6  */  { 7, 0 },
+      /* SWAP7  */  { 8, 0 },
+      /* SWAP8  */  { 9, 0 },
+      /* SWAP9  */  { 10, 0 },
+      /* SWAP10 */  { 11, 0 },
+      /* SWAP11 */  { 12, 0 },
+      /* SWAP12 */  { 13, 0 },
+      /* SWAP13 */  { 14, 0 },
+      /* SWAP14 */  { 15, 0 },
+      /* SWAP15 */  { 16, 0 },
+      /* SWAP16 */  { 17, 0 },
+
+      // a0s: Logging Operations
+      /* LOG0 */  { 2, -2 },
+      /* LOG1 */  { 3, -3 },
+      /* LOG2 */  { 4, -4 },
+      /* LOG3 */  { 5, -5 },
+      /* LOG4 */  { 6, -6 },
+      /* NULL */  { 0, 0 },
+      /* NULL */  { 0, 0 },
+      /* NULL */  { 0, 0 },
+      /* NULL */  { 0, 0 },
+      /* NULL */  { 0, 0 },
+      /* NULL */  { 0, 0 },
+      /* NULL */  { 0, 0 },
+      /* NULL */  { 0, 0 },
+      /* NULL */  { 0, 0 },
+      /* NULL */  { 0, 0 },
+      /* NULL */  { 0, 0 },
+
+      // b0s
+      /* NULL */  { 0, 0 },
+      /* NULL */  { 0, 0 },
+      /* NULL */  { 0, 0 },
+      /* NULL */  { 0, 0 },
+      /* NULL */  { 0, 0 },
+      /* NULL */  { 0, 0 },
+      /* NULL */  { 0, 0 },
+      /* NULL */  { 0, 0 },
+      /* NULL */  { 0, 0 },
+      /* NULL */  { 0, 0 },
+      /* NULL */  { 0, 0 },
+      /* NULL */  { 0, 0 },
+      /* NULL */  { 0, 0 },
+      /* NULL */  { 0, 0 },
+      /* NULL */  { 0, 0 },
+      /* NULL */  { 0, 0 },
+
+      // c0s
+      /* NULL */  { 0, 0 },
+      /* NULL */  { 0, 0 },
+      /* NULL */  { 0, 0 },
+      /* NULL */  { 0, 0 },
+      /* NULL */  { 0, 0 },
+      /* NULL */  { 0, 0 },
+      /* NULL */  { 0, 0 },
+      /* NULL */  { 0, 0 },
+      /* NULL */  { 0, 0 },
+      /* NULL */  { 0, 0 },
+      /* NULL */  { 0, 0 },
+      /* NULL */  { 0, 0 },
+      /* NULL */  { 0, 0 },
+      /* NULL */  { 0, 0 },
+      /* NULL */  { 0, 0 },
+      /* NULL */  { 0, 0 },
+
+      // d0s
+      /* NULL */  { 0, 0 },
+      /* NULL */  { 0, 0 },
+      /* NULL */  { 0, 0 },
+      /* NULL */  { 0, 0 },
+      /* NULL */  { 0, 0 },
+      /* NULL */  { 0, 0 },
+      /* NULL */  { 0, 0 },
+      /* NULL */  { 0, 0 },
+      /* NULL */  { 0, 0 },
+      /* NULL */  { 0, 0 },
+      /* NULL */  { 0, 0 },
+      /* NULL */  { 0, 0 },
+      /* NULL */  { 0, 0 },
+      /* NULL */  { 0, 0 },
+      /* NULL */  { 0, 0 },
+      /* NULL */  { 0, 0 },
+
+      // e0s
+      /* NULL */  { 0, 0 },
+      /* NULL */  { 0, 0 },
+      /* NULL */  { 0, 0 },
+      /* NULL */  { 0, 0 },
+      /* NULL */  { 0, 0 },
+      /* NULL */  { 0, 0 },
+      /* NULL */  { 0, 0 },
+      /* NULL */  { 0, 0 },
+      /* NULL */  { 0, 0 },
+      /* NULL */  { 0, 0 },
+      /* NULL */  { 0, 0 },
+      /* NULL */  { 0, 0 },
+      /* NULL */  { 0, 0 },
+      /* NULL */  { 0, 0 },
+      /* NULL */  { 0, 0 },
+      /* NULL */  { 0, 0 },
+
+      // f0s: System operations
+      /* CREATE       */  { 3, -2 },
+      /* CALL         */  { 7, -6 },
+      /* CALLCODE     */  { 7, -6 },
+      /* RETURN       */  { 2, -2 },
+      /* DELEGATECALL */  { 6, -5 },
+      /* CREATE2      */  { 4, -3 },
+      /* NULL         */  { 0, 0 },
+      /* NULL         */  { 0, 0 },
+      /* NULL         */  { 0, 0 },
+      /* NULL         */  { 0, 0 },
+      /* STATICCALL   */  { 6, -5 },
+      /* NULL         */  { 0, 0 },
+      /* NULL         */  { 0, 0 },
+      /* REVERT       */  { 2, -2 },
+      /* INVALID      */  { 0, 0 },
+      /* SELFDESTRUCT */  { 1, -1 }
+    };
+  }
+
   #if (OPTRACE == true)
   static std::string opcodeToString (uint8_t op) {
     std::map<uint8_t, std::string> opToStrings = {
@@ -7,6 +7,7 @@
 #include "tables.hpp"
 #include "context.hpp"
 #include "stack.hpp"
+#include "sha3_memo.hpp"
 #include <boost/multiprecision/cpp_int.hpp>
 
 namespace eosio_evm {
@@ -15,17 +16,32 @@ namespace eosio_evm {
   // Forward Declarations
   class evm;
 
+  // Cached storage slot, value is written to the table on commit if it differs from committed
+  struct StorageSlot {
+    uint256_t value;
+    uint256_t committed;
+  };
+
   class Processor {
   private:
     EthereumTransaction& transaction;           // the transaction object
     evm* contract;                              // pointer to parent contract (to call EOSIO actions)
     Context* ctx;                               // pointer to the current context
-    std::vector<std::unique_ptr<Context>> ctxs; // the stack of contexts (one per nested call)
+    std::vector<std::unique_ptr<Frame>> frames; // frames by call depth, kept for reuse after their context returns
+    size_t depth = 0;                           // number of active contexts (one per nested call)
+    ArenaMap<uint64_t, ArenaMap<uint256_t, StorageSlot>> storage; // storage by scope and key, written back by commit_storage
+    Sha3Memo sha3_memo;                         // hashes of 64 byte SHA3 inputs (mapping slots) seen in this transaction
+
+    // Slots of a storage scope, created on first use
+    inline ArenaMap<uint256_t, StorageSlot>& get_slots(const uint64_t& scope) {
+      return storage.try_emplace(scope, storage.get_allocator()).first->second;
+    }
 
   public:
     Processor(EthereumTransaction& transaction, evm* contract)
       : transaction(transaction),
-        contract(contract)
+        contract(contract),
+        storage(ArenaAllocator<std::pair<const uint64_t, ArenaMap<uint256_t, StorageSlot>>>(transaction.arena))
     {}
 
     void process_transaction(const Account& caller);
@@ -45,20 +61,24 @@ namespace eosio_evm {
       uint256_t gas_left,
       const bool is_static,
       const uint256_t call_value,
-      std::vector<uint8_t>&& input,
-      Program&& prog,
-      SuccessHandler&& success_cb,
-      ErrorHandler&& error_cb
+      SharedBytes input,
+      std::shared_ptr<const Program> prog,
+      const Continuation& cont
     );
+    void resume(const Continuation& cont, const Exception* ex, SharedBytes output, const uint256_t& sub_gas_used);
     void dispatch();
+    std::shared_ptr<const Program> get_program(const Account& account);
 
     // Can return/throw errors
-    bool access_mem(const uint256_t& offset, const uint256_t& size);
-    bool prepare_mem_access(const uint256_t& offset, const uint64_t& size);
+    bool access_mem(const uint256_t& offset, const uint256_t& size, uint64_t& offset64, uint64_t& size64);
+    bool access_mem(const uint256_t& offset, const uint64_t& size, uint64_t& offset64);
+    bool prepare_mem_access(const uint64_t& offset, const uint64_t& size);
+    void copy_to_mem(const uint256_t& mem_index, const uint256_t& input_index, const uint256_t& size, const uint8_t* src, const uint64_t& src_size);
     bool jump_to(const uint256_t& newPc);
     bool use_gas(uint256_t amount);
+    bool begin_block(const BasicBlock& block);
     bool process_sstore_gas(uint256_t original_value, uint256_t current_value, uint256_t new_value);
-    bool throw_error(const Exception& exception, const std::vector<uint8_t>& output);
+    bool throw_error(const Exception& exception, SharedBytes output);
 
     // State
     struct AccountResult {
@@ -73,22 +93,24 @@ namespace eosio_evm {
     void increment_nonce(const Address& address);
     void set_code(const Address& address, const std::vector<uint8_t>& code);
     void selfdestruct(const Address& addr);
-    void kill_storage(const uint64_t& address_index);
+    void kill_storage(const Account& account);
+    bool has_storage(const uint64_t& scope);
     bool transfer_internal(const Address& from, const Address& to, const uint256_t& amount);
-    void throw_stack();
 
     // Reverting
     void remove_code(const Address& address);
     void remove_account(const Address& address);
     void decrement_nonce(const Address& address);
+    void restore_storage(const Address& address);
 
     // Storage
-    void storekv(const uint64_t& address_index, const uint256_t& key, const uint256_t& value);
-    uint256_t loadkv(const uint64_t& address_index, const uint256_t& key);
+    void storekv(const uint64_t& scope, const uint256_t& key, StorageSlot& slot, const uint256_t& value);
+    StorageSlot& loadkv(const uint64_t& scope, const uint256_t& key);
+    void commit_storage();
 
     // Precompile
     void precompile_execute(uint256_t address);
-    void precompile_return(const std::vector<uint8_t>& output);
+    void precompile_return(SharedBytes output);
     void precompile_not_implemented();
     void precompile_ecrecover();
 
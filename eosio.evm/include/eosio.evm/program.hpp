@@ -6,30 +6,141 @@
 
 namespace eosio_evm
 {
+  static constexpr uint32_t NO_BLOCK = std::numeric_limits<uint32_t>::max();
+  static constexpr uint64_t NO_INSTRUCTION = std::numeric_limits<uint64_t>::max();
+
+  // Pre-decoded instruction
+  struct Instruction
+  {
+    uint8_t opcode;
+    uint32_t pc;    // Offset of the opcode in code
+    uint32_t arg;   // PUSH: index into push_values
+    uint32_t block; // Index into blocks if this instruction starts a basic block, NO_BLOCK otherwise
+  };
+
+  // Basic block: starts at code start, a JUMPDEST or after a terminating instruction
+  // Gas and stack bounds are checked once on entry instead of per instruction
+  struct BasicBlock
+  {
+    uint64_t gas;             // Sum of static gas (OpFees) of all instructions in the block
+    int32_t stack_req;        // Minimum stack height required on entry
+    int32_t stack_max_growth; // Maximum stack growth relative to entry
+  };
+
   class Program
   {
   public:
-    const std::vector<uint8_t> code;
-    const std::set<uint64_t> jump_dests;
+    std::vector<uint8_t> code;
+    std::vector<Instruction> instructions;
+    std::vector<uint256_t> push_values;
+    std::vector<BasicBlock> blocks;
+
+    // Jump destinations: one bit per code byte set at JUMPDEST offsets, the number of
+    // JUMPDESTs before each bitmap word and the instruction index of each JUMPDEST
+    std::vector<uint64_t> jumpdest_bits;
+    std::vector<uint32_t> jumpdest_ranks;
+    std::vector<uint32_t> jumpdest_instructions;
 
-    Program(const std::vector<uint8_t>&& c)
-      : code(c),
-        jump_dests(compute_jump_dests(code)) {}
+    Program(std::vector<uint8_t> c)
+      : code(std::move(c))
+    {
+      analyze();
+    }
+
+    // Returns the instruction index of the JUMPDEST at offset, NO_INSTRUCTION if invalid
+    inline uint64_t find_jumpdest(const uint64_t offset) const
+    {
+      if (offset >= code.size()) {
+        return NO_INSTRUCTION;
+      }
+
+      const auto word = offset / 64;
+      const auto bit = uint64_t(1) << (offset % 64);
+      if ((jumpdest_bits[word] & bit) == 0) {
+        return NO_INSTRUCTION;
+      }
+
+      const auto rank = jumpdest_ranks[word] + __builtin_popcountll(jumpdest_bits[word] & (bit - 1));
+      return jumpdest_instructions[rank];
+    }
 
   private:
-    std::set<uint64_t> compute_jump_dests(const std::vector<uint8_t>& code)
+    // Instructions that end a basic block. Instructions that observe gas_left
+    // (GAS, SSTORE, calls and creates) also end it so that no gas is charged
+    // ahead of them for the instructions that follow.
+    static bool is_terminator(const uint8_t op)
+    {
+      switch (op) {
+        case JUMP: case JUMPI: case STOP: case RETURN: case REVERT: case INVALID: case SELFDESTRUCT:
+        case GAS: case SSTORE:
+        case CALL: case CALLCODE: case DELEGATECALL: case STATICCALL: case CREATE: case CREATE2:
+          return true;
+        default:
+          return false;
+      }
+    }
+
+    // Single pass over code decoding PUSH immediates and splitting basic blocks
+    void analyze()
     {
-      std::set<uint64_t> dests;
+      jumpdest_bits.resize((code.size() + 63) / 64);
 
+      bool block_start = true;
+      int32_t stack_change = 0;
       for (uint64_t i = 0; i < code.size(); i++) {
         const auto op = code[i];
+        Instruction instr = { op, static_cast<uint32_t>(i), 0, NO_BLOCK };
+
+        // New basic block
+        if (block_start || op == JUMPDEST) {
+          instr.block = static_cast<uint32_t>(blocks.size());
+          blocks.push_back({ 0, 0, 0 });
+          stack_change = 0;
+        }
+
+        // Static gas and stack bounds
+        auto& block = blocks.back();
+        const auto& stack_req = OpStack::by_code[op];
+        block.gas += OpFees::by_code[op];
+        block.stack_req = std::max(block.stack_req, stack_req.height - stack_change);
+        stack_change += stack_req.change;
+        block.stack_max_growth = std::max(block.stack_max_growth, stack_change);
+
         if (op == JUMPDEST) {
-          dests.insert(i);
+          jumpdest_bits[i / 64] |= uint64_t(1) << (i % 64);
+          jumpdest_instructions.push_back(static_cast<uint32_t>(instructions.size()));
         } else if (op >= PUSH1 && op <= PUSH32) {
-          i += op - PUSH1 + 1;
+          // Immediate is zero padded if truncated by the end of code
+          const uint8_t bytes = op - PUSH1 + 1;
+          uint256_t imm = 0;
+          for (uint64_t j = i + 1; j <= i + bytes; j++) {
+            imm = (imm << 8) | (j < code.size() ? code[j] : 0);
+          }
+
+          instr.arg = static_cast<uint32_t>(push_values.size());
+          push_values.push_back(imm);
+          i += bytes;
         }
+
+        block_start = is_terminator(op);
+        instructions.push_back(instr);
+      }
+
+      // Implicit STOP at the end of code, execution never runs past the stream
+      Instruction stop = { STOP, static_cast<uint32_t>(code.size()), 0, NO_BLOCK };
+      if (block_start) {
+        stop.block = static_cast<uint32_t>(blocks.size());
+        blocks.push_back({ 0, 0, 0 });
+      }
+      instructions.push_back(stop);
+
+      // Rank JUMPDESTs per bitmap word
+      jumpdest_ranks.resize(jumpdest_bits.size());
+      uint32_t count = 0;
+      for (size_t w = 0; w < jumpdest_bits.size(); w++) {
+        jumpdest_ranks[w] = count;
+        count += __builtin_popcountll(jumpdest_bits[w]);
       }
-      return dests;
     }
   };
-}
\ No newline at end of file
+}
@@ -0,0 +1,68 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Copyright (c) 2020 Syed Jafri. All rights reserved.
+// Licensed under the MIT License.
+
+#pragma once
+
+namespace eosio_evm
+{
+  // Direct mapped cache of keccak hashes of 64 byte inputs, keyed by content
+  //
+  // Solidity hashes key . slot for every mapping access, so the same inputs
+  // repeat within a transaction. The table is allocated on first use.
+  class Sha3Memo
+  {
+  private:
+    struct Entry {
+      uint8_t input[64];
+      uint256_t hash;
+      bool used;
+    };
+
+    std::vector<Entry> entries;
+
+    static constexpr size_t CAPACITY_BITS = 6;
+    static constexpr size_t CAPACITY = 1 << CAPACITY_BITS;
+
+    // Folds the eight lanes of the input into a table index
+    //
+    // Takes the top bits of the product, the only ones every input bit reaches
+    static inline size_t index(const uint8_t* input)
+    {
+      uint64_t h = 0;
+      for (size_t i = 0; i < 64; i += 8) {
+        uint64_t lane;
+        std::memcpy(&lane, input + i, 8);
+        h = (h ^ lane) * 0x9e3779b97f4a7c15ULL;
+      }
+      return h >> (64 - CAPACITY_BITS);
+    }
+
+  public:
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+
+    // Returns the hash of the 64 bytes at input
+    uint256_t hash(const uint8_t* input)
+    {
+      if (entries.empty()) {
+        entries.resize(CAPACITY);
+      }
+
+      auto& entry = entries[index(input)];
+      if (entry.used && std::memcmp(entry.input, input, 64) == 0) {
+        hits++;
+        return entry.hash;
+      }
+
+      misses++;
+      uint8_t h[32];
+      keccak_256_64(input, h);
+
+      std::memcpy(entry.input, input, 64);
+      entry.hash = intx::be::load<uint256_t>(h);
+      entry.used = true;
+      return entry.hash;
+    }
+  };
+} // namespace eosio_evm
@@ -7,26 +7,60 @@
 #include "exception.hpp"
 
 namespace eosio_evm {
-  // Forward declaration
-  class Context;
-
   // Stack used by Processor
+  //
+  // Contiguous words growing upwards from st[0]. Storage is allocated on demand
+  // and doubles up to MAX_STACK_SIZE, so the frames of a deep call chain only
+  // hold the words they use. Processor::begin_block validates the bounds of a
+  // whole basic block and reserves its growth, so all accessors below are unchecked.
   class Stack
   {
+  private:
+    std::unique_ptr<uint256_t[]> buffer;
+    uint64_t capacity = 0;
+
+    static constexpr uint64_t MIN_CAPACITY = 32;
+
+    void grow(const uint64_t& n)
+    {
+      const auto new_capacity = std::min<uint64_t>(std::max({ n, capacity * 2, MIN_CAPACITY }), MAX_STACK_SIZE);
+      const auto items = size();
+
+      std::unique_ptr<uint256_t[]> new_buffer(new uint256_t[new_capacity]);
+      std::copy(st, sp, new_buffer.get());
+
+      buffer   = std::move(new_buffer);
+      capacity = new_capacity;
+      st       = buffer.get();
+      sp       = st + items;
+    }
+
   public:
-    std::deque<uint256_t> st;
-    Context* ctx;
-    std::optional<std::string> stack_error;
-
-    Stack(Context* _ctx): ctx(_ctx) {};
-
-    uint256_t pop();
-    uint256_t pop_addr();
-    void push(const uint256_t& val);
-    uint64_t size() const;
-    void swap(uint64_t i);
-    void dup(uint64_t a);
+    uint256_t* st = nullptr;
+    uint256_t* sp = nullptr; // One past the top item
+
+    Stack() = default;
+    Stack(const Stack&) = delete;
+    Stack& operator=(const Stack&) = delete;
+
+    // Makes room for n items, n must not exceed MAX_STACK_SIZE
+    inline void reserve(const uint64_t& n) { if (n > capacity) grow(n); }
+
+    inline uint256_t pop() { return *--sp; }
+    inline void push(const uint256_t& val) { *sp++ = val; }
+    inline uint256_t& top(uint64_t i = 0) { return sp[-1 - static_cast<int64_t>(i)]; }
+    inline uint64_t size() const { return static_cast<uint64_t>(sp - st); }
+    inline void swap(uint64_t i) { std::swap(top(), top(i)); }
+    inline void dup(uint64_t a) { push(top(a)); }
+    inline void clear() { sp = st; }
+
+    inline uint256_t pop_addr()
+    {
+      static const uint256_t MASK_160 = (uint256_t(1) << 160) - 1;
+      return pop() & MASK_160;
+    }
+
     void print();
     std::string as_array();
   };
-}
\ No newline at end of file
+}
@@ -10,8 +10,14 @@ namespace eosio_evm {
     eosio::checksum160 address;
     eosio::name account;
     uint64_t nonce;
-    std::vector<uint8_t> code;
+    std::vector<uint8_t> code; // Only rows created before the code table hold code inline
     bigint::checksum256 balance;
+    eosio::binary_extension<eosio::checksum256> code_hash; // Key into the code table
+    eosio::binary_extension<uint32_t> code_size;
+    eosio::binary_extension<uint32_t> storage_generation; // Incremented when storage is wiped
+
+    // Index must fit the low 32 bits of the storage scope, see get_storage_scope
+    static constexpr uint64_t MAX_INDEX = UINT32_MAX;
 
     Account () = default;
     Account (uint256_t _address): address(addressToChecksum160(_address)) {}
@@ -21,8 +27,35 @@ namespace eosio_evm {
     uint256_t get_address() const { return checksum160ToAddress(address); };
     uint256_t get_balance() const { return balance; };
     uint64_t get_nonce() const { return nonce; };
-    std::vector<uint8_t> get_code() const { return code; };
-    bool is_empty() const { return nonce == 0 && balance == 0 && code.size() == 0; };
+    uint64_t get_code_size() const { return code_size.has_value() ? code_size.value() : code.size(); };
+
+    // Rows written before code_hash existed are hashed on demand until migrated
+    uint256_t get_code_hash() const {
+      if (code_hash.has_value()) {
+        return checksum256ToValue(code_hash.value());
+      }
+      const auto h = keccak_256(code);
+      return intx::be::unsafe::load<uint256_t>(h.data());
+    };
+
+    // Code itself is stored in the code table, see evm::add_code
+    void set_code_ref(const eosio::checksum256& hash, const uint64_t& size) {
+      code.clear();
+      code_hash.emplace(hash);
+      code_size.emplace(static_cast<uint32_t>(size));
+    };
+    void clear_code() {
+      static const auto empty_code_hash = eosio::checksum256(keccak_256(std::vector<uint8_t>{}));
+      set_code_ref(empty_code_hash, 0);
+    };
+    bool has_inline_code() const { return !code.empty(); };
+
+    // Scope of AccountState rows, the index itself until storage is first wiped.
+    // Generation is kept in the high 32 bits, so index is bounded by MAX_INDEX
+    uint64_t get_storage_scope() const {
+      return (static_cast<uint64_t>(storage_generation.value_or(0)) << 32) | index;
+    };
+    bool is_empty() const { return nonce == 0 && balance == 0 && get_code_size() == 0; };
 
     eosio::checksum256 by_address() const { return pad160(address); };
 
@@ -34,13 +67,26 @@ namespace eosio_evm {
       eosio::print("\nIndex ", index);
       eosio::print("\nEOS Account " + account.to_string());
       eosio::print("\nBalance ", intx::to_string(balance));
-      eosio::print("\nCode ", bin2hex(code));
+      eosio::print("\nCode Size ", get_code_size());
       eosio::print("\nNonce ", nonce);
       eosio::print("\n---Acc Info End---\n");
     }
     #endif /* TESTING */
 
-    EOSLIB_SERIALIZE(Account, (index)(address)(account)(nonce)(code)(balance));
+    EOSLIB_SERIALIZE(Account, (index)(address)(account)(nonce)(code)(balance)(code_hash)(code_size)(storage_generation));
+  };
+
+  // Contract code shared by all accounts with the same code hash
+  struct [[eosio::table, eosio::contract("eosio.evm")]] AccountCode {
+    uint64_t index;
+    eosio::checksum256 hash;
+    std::vector<uint8_t> code;
+    uint64_t refcount;
+
+    uint64_t primary_key() const { return index; };
+    eosio::checksum256 by_hash() const { return hash; };
+
+    EOSLIB_SERIALIZE(AccountCode, (index)(hash)(code)(refcount));
   };
 
   struct [[eosio::table, eosio::contract("eosio.evm")]] AccountState {
@@ -54,11 +100,24 @@ namespace eosio_evm {
     EOSLIB_SERIALIZE(AccountState, (index)(key)(value));
   };
 
+  // Storage scope wiped by SELFDESTRUCT or CREATE2, rows are erased by cleanstorage
+  struct [[eosio::table, eosio::contract("eosio.evm")]] StaleScope {
+    uint64_t scope;
+
+    uint64_t primary_key() const { return scope; };
+
+    EOSLIB_SERIALIZE(StaleScope, (scope));
+  };
+
   typedef eosio::multi_index<"account"_n, Account,
     eosio::indexed_by<eosio::name("byaddress"), eosio::const_mem_fun<Account, eosio::checksum256, &Account::by_address>>,
     eosio::indexed_by<eosio::name("byaccount"), eosio::const_mem_fun<Account, uint64_t, &Account::get_account_value>>
   > account_table;
+  typedef eosio::multi_index<"accountcode"_n, AccountCode,
+    eosio::indexed_by<eosio::name("byhash"), eosio::const_mem_fun<AccountCode, eosio::checksum256, &AccountCode::by_hash>>
+  > account_code_table;
   typedef eosio::multi_index<"accountstate"_n, AccountState,
     eosio::indexed_by<eosio::name("bykey"), eosio::const_mem_fun<AccountState, eosio::checksum256, &AccountState::by_key>>
   > account_state_table;
+  typedef eosio::multi_index<"stalescope"_n, StaleScope> stale_scope_table;
 }
\ No newline at end of file
@@ -8,6 +8,7 @@
 #include "constants.hpp"
 #include "util.hpp"
 #include "tables.hpp"
+#include "arena.hpp"
 
 namespace eosio_evm
 {
@@ -90,43 +91,98 @@ namespace eosio_evm
   /**
    * State modifications: Stored for Reverting
    */
-  enum class StateModificationType {
-    NONE = 0,
+  enum class StateModificationType : uint8_t {
     STORE_KV,
     CREATE_ACCOUNT,
     SET_CODE,
     INCREMENT_NONCE,
-    ORIGINAL_STORAGE,
+    KILL_STORAGE,
     TRANSFER,
     LOG,
     SELF_DESTRUCT
   };
   using SMT = StateModificationType;
 
-  struct StateModification {
-    StateModificationType type;
-    uint64_t index;
-    uint256_t key;
-    uint256_t oldvalue;
-    uint256_t amount;
-    uint256_t newvalue;
+  // Journal of state modifications
+  //
+  // Entries hold their type and an index into the payload vector of that type,
+  // LOG and SELF_DESTRUCT have no payload. Checkpoints are entry counts.
+  struct StateJournal {
+    struct Entry {
+      StateModificationType type;
+      uint32_t pos;
+    };
+    struct StorageChange {
+      uint64_t index;
+      uint256_t key;
+      uint256_t oldvalue;
+    };
+    struct Transfer {
+      Address from;
+      Address to;
+      uint256_t amount;
+    };
+
+    ArenaVector<Entry> entries;
+    ArenaVector<StorageChange> storage_changes;
+    ArenaVector<Address> addresses; // CREATE_ACCOUNT, SET_CODE, INCREMENT_NONCE and KILL_STORAGE
+    ArenaVector<Transfer> transfers;
+
+    explicit StateJournal(Arena& arena)
+      : entries(ArenaAllocator<Entry>(arena)),
+        storage_changes(ArenaAllocator<StorageChange>(arena)),
+        addresses(ArenaAllocator<Address>(arena)),
+        transfers(ArenaAllocator<Transfer>(arena))
+    {}
+
+    inline size_t size() const { return entries.size(); }
+
+    inline void add_store_kv(const uint64_t& index, const uint256_t& key, const uint256_t& oldvalue) {
+      entries.push_back({ SMT::STORE_KV, static_cast<uint32_t>(storage_changes.size()) });
+      storage_changes.push_back({ index, key, oldvalue });
+    }
+    inline void add_address(const StateModificationType& type, const Address& address) {
+      entries.push_back({ type, static_cast<uint32_t>(addresses.size()) });
+      addresses.push_back(address);
+    }
+    inline void add_transfer(const Address& from, const Address& to, const uint256_t& amount) {
+      entries.push_back({ SMT::TRANSFER, static_cast<uint32_t>(transfers.size()) });
+      transfers.push_back({ from, to, amount });
+    }
+    inline void add(const StateModificationType& type) {
+      entries.push_back({ type, 0 });
+    }
 
-    #if (TESTING == true)
-    void print() {
-      std::map<StateModificationType, std::string> reverseState = {
-        { SMT::STORE_KV, "STORE_KV"   },
-        { SMT::CREATE_ACCOUNT, "CREATE_ACCOUNT"    },
-        { SMT::SET_CODE, "SET_CODE"    },
-        { SMT::INCREMENT_NONCE, "INCREMENT_NONCE"    },
-        { SMT::ORIGINAL_STORAGE, "ORIGINAL_STORAGE"    },
-        { SMT::TRANSFER, "TRANSFER"    },
-        { SMT::LOG, "LOG"    },
-        { SMT::SELF_DESTRUCT, "SELF_DESTRUCT"    }
-      };
+    // Drops entries past checkpoint, payloads are cut at the first dropped entry of their type
+    void truncate(const size_t& checkpoint) {
+      auto storage_size  = storage_changes.size();
+      auto address_size  = addresses.size();
+      auto transfer_size = transfers.size();
+
+      for (auto i = entries.size(); i-- > checkpoint; ) {
+        switch (entries[i].type) {
+          case SMT::STORE_KV:
+            storage_size = entries[i].pos;
+            break;
+          case SMT::CREATE_ACCOUNT:
+          case SMT::SET_CODE:
+          case SMT::INCREMENT_NONCE:
+          case SMT::KILL_STORAGE:
+            address_size = entries[i].pos;
+            break;
+          case SMT::TRANSFER:
+            transfer_size = entries[i].pos;
+            break;
+          default:
+            break;
+        }
+      }
 
-      eosio::print("\nType: ", reverseState[type], ", Index: ", index, ", Key: ", intx::to_string(key), " OldValue: ", intx::to_string(oldvalue), " NewValue: ", intx::to_string(newvalue), " Amount: ", intx::to_string(amount));
+      entries.resize(checkpoint);
+      storage_changes.resize(storage_size);
+      addresses.resize(address_size);
+      transfers.resize(transfer_size);
     }
-    #endif /** Testing **/
   };
 
   struct EthereumTransaction {
@@ -142,14 +198,17 @@ namespace eosio_evm
     std::optional<Address> created_address;   // If create transaction, the address that was created
     std::unique_ptr<Account> sender_account;  // Pointer to sender account
     std::vector<Address> selfdestruct_list;   // SELFDESTRUCT List
+    std::vector<uint64_t> stale_scopes;       // Storage scopes wiped in this transaction
     LogHandler logs = {};                     // Log handler for transaction
     eosio::checksum256 hash = {};             // Hash of transaction
     std::vector<std::string> errors;          // Keeps track of errors
+    uint64_t index = 0;                       // Position in a rawbatch
+    uint256_t prior_gas_used = 0;             // Gas used by the transactions before it in a rawbatch
 
     uint256_t gas_used;     // Gas used in transaction
     uint256_t gas_refunds;  // Refunds processed in transaction
-    std::vector<StateModification> state_modifications;                  // State modifications
-    std::map<uint64_t, std::map<uint256_t, uint256_t>> original_storage; // Cache for SSTORE
+    Arena arena;                                                         // Backs the journal and storage caches, freed with the transaction
+    StateJournal state_modifications{arena};                             // State modifications
 
     // Signature data
     uint8_t v;   // Recovery ID
@@ -165,19 +224,32 @@ namespace eosio_evm
       // Max Transaction size
       eosio::check(encoded.size() < MAX_TX_SIZE, "Invalid Transaction: Max size of a transaction is 128 KB");
 
-      // Decode
-      auto rlp = rlp::decode(encoded);
-      auto values = rlp.values;
+      // Decode in place, only canonical encodings are accepted so the input is its own re-encoding
+      const auto bytes = reinterpret_cast<const uint8_t*>(encoded.data());
+      rlp::RLPReader reader(bytes, encoded.size());
+      rlp::RLPItem list, item;
+      eosio::check(reader.next(list) && list.is_list && reader.done(), "Invalid Transaction: RLP could not be decoded");
 
-      nonce     = from_big_endian(&values[0].value[0], values[0].value.size());
-      gas_price = from_big_endian(&values[1].value[0], values[1].value.size());
-      gas_limit = from_big_endian(&values[2].value[0], values[2].value.size());
-      to        = values[3].value;
-      value     = from_big_endian(&values[4].value[0], values[4].value.size());
-      data      = values[5].value;
-      v         = values[6].value[0];
-      r         = from_big_endian(&values[7].value[0], values[7].value.size());
-      s         = from_big_endian(&values[8].value[0], values[8].value.size());
+      rlp::RLPReader fields(list);
+      const auto next_scalar = [&](const size_t& max_size) {
+        eosio::check(fields.next_scalar(item, max_size), "Invalid Transaction: RLP could not be decoded");
+        return from_big_endian(item.data, item.size);
+      };
+      const auto next_bytes = [&]() {
+        eosio::check(fields.next_bytes(item), "Invalid Transaction: RLP could not be decoded");
+        return std::vector<uint8_t>(item.data, item.data + item.size);
+      };
+
+      nonce     = next_scalar(32);
+      gas_price = next_scalar(32);
+      gas_limit = next_scalar(32);
+      to        = next_bytes();
+      value     = next_scalar(32);
+      data      = next_bytes();
+      v         = static_cast<uint8_t>(next_scalar(1));
+      r         = next_scalar(32);
+      s         = next_scalar(32);
+      eosio::check(fields.done(), "Invalid Transaction: RLP could not be decoded");
 
       // Validate To Address
       eosio::check(to.empty() || to.size() == 20, "Invalid Transaction: to address must be 40 characters long if provided (excluding 0x prefix)");
@@ -189,10 +261,9 @@ namespace eosio_evm
       eosio::check(value >= 0, "Invalid Transaction: Value cannot be negative.");
 
       // Hash
-      hash = keccak_256(encode());
+      hash = keccak_256(bytes, encoded.size());
 
-      // RAM Payer
-      eosio::require_auth(ram_payer_account);
+      // RAM Payer, authorized by the action
       ram_payer = ram_payer_account;
 
       // Gas
@@ -239,11 +310,11 @@ namespace eosio_evm
     {
       if (is_pre_eip_155(v))
       {
-        return keccak_256(rlp::encode(nonce, gas_price, gas_limit, to, value, data));
+        return rlp::keccak(nonce, gas_price, gas_limit, to, value, data);
       }
       else
       {
-        return keccak_256(rlp::encode( nonce, gas_price, gas_limit, to, value, data, CURRENT_CHAIN_ID, 0, 0 ));
+        return rlp::keccak(nonce, gas_price, gas_limit, to, value, data, CURRENT_CHAIN_ID, 0, 0);
       }
     }
 
@@ -304,25 +375,6 @@ namespace eosio_evm
       }
     }
 
-    /**
-     * State Modifications and original storage
-     */
-    inline void add_modification(const StateModification& modification) {
-      state_modifications.emplace_back(modification);
-    }
-    inline uint256_t find_original(const uint64_t& address_index, const uint256_t& key) {
-      if (original_storage.count(address_index) == 0 || original_storage[address_index].count(key) == 0) {
-        return 0;
-      } else {
-        return original_storage[address_index][key];
-      }
-    }
-    inline void emplace_original(const uint64_t& address_index, const uint256_t& key, const uint256_t& value) {
-      if (original_storage.count(address_index) == 0 || original_storage[address_index].count(key) == 0) {
-        original_storage[address_index][key] = value;
-      }
-    }
-
     std::string errors_as_json_string() const {
       std::string output = "[";
       for (auto i = 0; i < errors.size(); i++) {
@@ -348,7 +400,7 @@ namespace eosio_evm
           "\"r\": \"", intx::hex(r), "\",",
           "\"s\": \"", intx::hex(s), "\",",
           "\"createdAddress\": \"", created_address ? intx::hex(*created_address) : "", "\",",
-          "\"cumulativeGasUsed\": \"", intx::hex(gas_used), "\",",
+          "\"cumulativeGasUsed\": \"", intx::hex(prior_gas_used + gas_used), "\",",
           "\"gasUsed\": \"", intx::hex(gas_used), "\",",
           "\"gasLimit\": \"", intx::hex(gas_limit), "\",",
           "\"gasPrice\": \"", intx::hex(gas_price), "\",",
@@ -358,7 +410,7 @@ namespace eosio_evm
           "\"output\": \"", bin2hex(result.output), "\","
           "\"errors\": ", errors_as_json_string(), ","
           "\"transactionHash\": \"", hash, "\"", ","
-          "\"transactionIndex\": \"0\""
+          "\"transactionIndex\": \"", index, "\""
         "}"
       );
     }
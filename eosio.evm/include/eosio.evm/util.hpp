@@ -45,6 +45,30 @@ namespace eosio_evm
     return (static_cast<int64_t>(size_in_bytes) + (WORD_SIZE - 1)) / WORD_SIZE;
   }
 
+  /**
+   * Narrowing of 256 bit offsets and sizes, the upper 192 bits are checked once
+   */
+  inline constexpr bool fits_u64(const uint256_t& value)
+  {
+    return (value.lo.hi | value.hi.lo | value.hi.hi) == 0;
+  }
+
+  // Returns true if value exceeds limit, otherwise stores it in out
+  inline constexpr bool narrow_u64(const uint256_t& value, const uint64_t& limit, uint64_t& out)
+  {
+    if (!fits_u64(value) || value.lo.lo > limit) {
+      return true;
+    }
+    out = value.lo.lo;
+    return false;
+  }
+
+  // Returns value, or limit if value exceeds it (source offsets past the end read zeros)
+  inline constexpr uint64_t saturate_u64(const uint256_t& value, const uint64_t& limit)
+  {
+    return fits_u64(value) && value.lo.lo < limit ? value.lo.lo : limit;
+  }
+
   template <typename T>
   static T shrink(uint256_t i)
   {
@@ -105,9 +129,17 @@ namespace eosio_evm
    */
   inline void keccak_256(
     const unsigned char* input,
-    unsigned int inputByteLen,
+    size_t inputByteLen,
     unsigned char* output)
   {
+    // One and two words (slot hashing) skip the context
+    if (inputByteLen == 32) {
+      return keccak_256_32(input, output);
+    }
+    if (inputByteLen == 64) {
+      return keccak_256_64(input, output);
+    }
+
     // Ethereum started using Keccak and called it SHA3 before it was finalised.
     SHA3_CTX context;
     keccak_init(&context);
@@ -145,8 +177,7 @@ namespace eosio_evm
    */
   inline Address generate_address(const Address& sender, uint256_t nonce) {
     // RLP encode and keccak hash
-    const auto rlp_encoding = rlp::encode(sender, nonce);
-    std::array<uint8_t, 32u> buffer = keccak_256(rlp_encoding);
+    std::array<uint8_t, 32u> buffer = rlp::keccak(sender, nonce);
 
     // Copy right 160 bits from keccak buffer
     uint8_t right_160[32] = {};
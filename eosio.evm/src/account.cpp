@@ -56,7 +56,7 @@ namespace eosio_evm {
     });
 
     // Modification record
-    transaction.add_modification({ SMT::TRANSFER, 0, from, to, amount, 0 });
+    transaction.state_modifications.add_transfer(from, to, amount);
 
     // Return false for no error
     return false;
@@ -71,7 +71,7 @@ namespace eosio_evm {
         a.nonce += 1;
       });
 
-      transaction.add_modification({ SMT::INCREMENT_NONCE, 0, address, existing_address->get_nonce() - 1, 0, existing_address->get_nonce()});
+      transaction.state_modifications.add_address(SMT::INCREMENT_NONCE, address);
     }
   }
 
@@ -93,9 +93,12 @@ namespace eosio_evm {
     auto accounts_byaddress = contract->_accounts.get_index<eosio::name("byaddress")>();
     auto existing_address = accounts_byaddress.find(toChecksum256(address));
     if (existing_address != accounts_byaddress.end()) {
+      const auto code_hash = contract->add_code(transaction.ram_payer, code);
+      contract->release_code(*existing_address);
       accounts_byaddress.modify(existing_address, transaction.ram_payer, [&](auto& a) {
-        a.code = code;
+        a.set_code_ref(code_hash, code.size());
       });
+      contract->_programs.erase(existing_address->primary_key());
     }
   }
 
@@ -104,9 +107,11 @@ namespace eosio_evm {
     auto accounts_byaddress = contract->_accounts.get_index<eosio::name("byaddress")>();
     auto existing_address = accounts_byaddress.find(toChecksum256(address));
     if (existing_address != accounts_byaddress.end()) {
+      contract->release_code(*existing_address);
       accounts_byaddress.modify(existing_address, eosio::same_payer, [&](auto& a) {
-        a.code = {};
+        a.clear_code();
       });
+      contract->_programs.erase(existing_address->primary_key());
     }
   }
 
@@ -142,7 +147,7 @@ namespace eosio_evm {
     // If account already exists
     if (existing_address != accounts_byaddress.end()) {
       // If it has nonce or non-empty code -> ERROR
-      if (existing_address->get_nonce() > 0 || !existing_address->get_code().empty())
+      if (existing_address->get_nonce() > 0 || existing_address->get_code_size() > 0)
       {
         static const auto empty_account = Account(address);
         return { empty_account, true };
@@ -152,11 +157,11 @@ namespace eosio_evm {
       else
       {
         if (is_contract) {
-          kill_storage(existing_address->primary_key());
+          kill_storage(*existing_address);
           accounts_byaddress.modify(existing_address, eosio::same_payer, [&](auto& a) {
             a.nonce += 1;
           });
-          transaction.add_modification({ SMT::INCREMENT_NONCE, 0, address, existing_address->get_nonce() - 1, 0, existing_address->get_nonce()});
+          transaction.state_modifications.add_address(SMT::INCREMENT_NONCE, address);
         }
         return { *existing_address, false };
       }
@@ -167,14 +172,15 @@ namespace eosio_evm {
 
     // Create address if it does not exists
     auto new_address = contract->_accounts.emplace(transaction.ram_payer, [&](auto& a) {
-      a.index   = contract->_accounts.available_primary_key();
+      a.index   = contract->next_account_index();
       a.nonce   = nonce;
       a.address = address_160;
       a.balance = 0;
+      a.clear_code();
     });
 
     // Add modification record
-    transaction.add_modification({ SMT::CREATE_ACCOUNT, 0, address, 0, 0, 0 });
+    transaction.state_modifications.add_address(SMT::CREATE_ACCOUNT, address);
 
     return { *new_address, false };
   }
@@ -189,6 +195,8 @@ namespace eosio_evm {
     auto existing_address   = accounts_byaddress.find(address_256);
 
     if (existing_address != accounts_byaddress.end()) {
+      contract->release_code(*existing_address);
+      contract->_programs.erase(existing_address->primary_key());
       accounts_byaddress.erase(existing_address);
     }
   }
@@ -203,86 +211,104 @@ namespace eosio_evm {
 
     if (existing_address != accounts_byaddress.end()) {
       // Kill storage first
-      kill_storage(existing_address->primary_key());
+      kill_storage(*existing_address);
 
       // Make account empty
+      contract->release_code(*existing_address);
       accounts_byaddress.modify(existing_address, eosio::same_payer, [&](auto& a) {
         a.nonce = 0;
         a.balance = 0;
-        a.code = {};
+        a.clear_code();
       });
+      contract->_programs.erase(existing_address->primary_key());
     }
   }
-  // TODO need to use table indirection instead to save for future processing.
-  void Processor::kill_storage(const uint64_t& address_index)
+
+  // Moves the account to a new, empty storage scope. The old scope is recorded
+  // as stale on commit and its rows are erased later by the cleanstorage action
+  void Processor::kill_storage(const Account& account)
   {
-    account_state_table accounts_states(contract->get_self(), address_index);
-    auto itr = accounts_states.end();
-    while (accounts_states.begin() != itr) {
-      --itr;
-      transaction.add_modification({ SMT::STORE_KV, address_index, checksum256ToValue(itr->by_key()), itr->value, 0, 0 });
-      itr = accounts_states.erase(itr);
+    // Nothing to wipe, the account keeps its scope
+    if (!has_storage(account.get_storage_scope())) {
+      return;
     }
+
+    // Generation fills the high 32 bits of the scope and must not wrap onto a used scope
+    const auto generation = account.storage_generation.value_or(0);
+    eosio::check(generation < std::numeric_limits<uint32_t>::max(), "storage generation of account overflowed");
+
+    transaction.stale_scopes.push_back(account.get_storage_scope());
+    contract->_accounts.modify(account, eosio::same_payer, [&](auto& a) {
+      a.storage_generation.emplace(generation + 1);
+    });
+    transaction.state_modifications.add_address(SMT::KILL_STORAGE, account.get_address());
   }
 
-  // Returns original state
-  void Processor::storekv(const uint64_t& address_index, const uint256_t& key, const uint256_t& value) {
-    // Get scoped state table for account state
-    account_state_table accounts_states(contract->get_self(), address_index);
-    auto accounts_states_bykey = accounts_states.get_index<eosio::name("bykey")>();
-    auto checksum_key          = toChecksum256(key);
-    auto account_state         = accounts_states_bykey.find(checksum_key);
+  // Only used while reverting
+  void Processor::restore_storage(const Address& address)
+  {
+    auto accounts_byaddress = contract->_accounts.get_index<eosio::name("byaddress")>();
+    auto existing_address = accounts_byaddress.find(toChecksum256(address));
+    eosio::check(!transaction.stale_scopes.empty(), "no stale storage scope to restore");
+    if (existing_address != accounts_byaddress.end()) {
+      const auto& storage_generation = existing_address->storage_generation;
+      eosio::check(storage_generation.has_value() && storage_generation.value() > 0, "storage generation of account out of sync");
+      const auto generation = storage_generation.value();
+      accounts_byaddress.modify(existing_address, eosio::same_payer, [&](auto& a) {
+        a.storage_generation.emplace(generation - 1);
+      });
 
+      // Kills are reverted in reverse order, so the last stale scope is the one restored
+      eosio::check(transaction.stale_scopes.back() == existing_address->get_storage_scope(), "stale storage scope out of sync");
+    }
+    transaction.stale_scopes.pop_back();
+  }
+
+  // True if the scope has rows or non-zero slots written in this transaction
+  bool Processor::has_storage(const uint64_t& scope)
+  {
+    auto cached = storage.find(scope);
+    if (cached != storage.end()) {
+      for (const auto& [key, slot] : cached->second) {
+        if (slot.value != 0) return true;
+      }
+    }
+
+    account_state_table accounts_states(contract->get_self(), scope);
+    return accounts_states.begin() != accounts_states.end();
+  }
+
+  // Only updates the cache, slot must have been returned by loadkv for the same scope and key
+  void Processor::storekv(const uint64_t& scope, const uint256_t& key, StorageSlot& slot, const uint256_t& value) {
     #if (PRINT_STATE == true)
     eosio::print(
-      "\n\nStore KV for address index ", address_index,
+      "\n\nStore KV for storage scope ", scope,
       "\nKey: ", intx::hex(key),
       "\nValue: ", intx::hex(value),
-      "\nFound: ", account_state != accounts_states_bykey.end(),
-      "\nValue is not 0: ", value != 0, "\n"
+      "\nOld Value: ", intx::hex(slot.value), "\n"
     );
-    if (account_state != accounts_states_bykey.end()) {
-      eosio::print("\nOld Value:", intx::hex(account_state->value));
-    }
     #endif
 
-    // Key found
-    if (account_state != accounts_states_bykey.end())
-    {
-      transaction.add_modification({ SMT::STORE_KV, address_index, key, account_state->value, 0, value });
+    transaction.state_modifications.add_store_kv(scope, key, slot.value);
+    slot.value = value;
+  }
 
-      if (value == 0)
-      {
-        accounts_states_bykey.erase(account_state);
-      }
-      else
-      {
-        accounts_states_bykey.modify(account_state, eosio::same_payer, [&](auto& a) {
-          a.value = value;
-        });
-      }
+  // Cached slot of the key, committed holds its value at the start of the transaction
+  StorageSlot& Processor::loadkv(const uint64_t& scope, const uint256_t& key) {
+    auto& slots = get_slots(scope);
+    auto cached = slots.find(key);
+    if (cached != slots.end()) {
+      return cached->second;
     }
-    // Key not found and new value exists
-    else if (value != 0)
-    {
-      transaction.add_modification({ SMT::STORE_KV, address_index, key, 0, 0, value });
-      accounts_states.emplace(transaction.ram_payer, [&](auto& a) {
-        a.index = accounts_states.available_primary_key();
-        a.key   = checksum_key;
-        a.value = value;
-      });
-    }
-  }
 
-  uint256_t Processor::loadkv(const uint64_t& address_index, const uint256_t& key) {
     // Get scoped state table for account
-    account_state_table accounts_states(contract->get_self(), address_index);
+    account_state_table accounts_states(contract->get_self(), scope);
     auto accounts_states_bykey = accounts_states.get_index<eosio::name("bykey")>();
     const auto checksum_key    = toChecksum256(key);
     auto account_state         = accounts_states_bykey.find(checksum_key);
 
     #if (PRINT_STATE == true)
-    eosio::print("\n\nLoad KV for address index ", address_index,
+    eosio::print("\n\nLoad KV for storage scope ", scope,
                  "\nKey: ", intx::hex(key),
                  "\nFound: ", account_state != accounts_states_bykey.end(), "\n");
     if (account_state != accounts_states_bykey.end()) {
@@ -292,10 +318,69 @@ namespace eosio_evm {
 
     // Value
     auto current_value = account_state != accounts_states_bykey.end() ? account_state->value : 0;
+    return slots.emplace(key, StorageSlot{ current_value, current_value }).first->second;
+  }
+
+  // Writes slots that changed during the transaction to their tables and records stale scopes
+  void Processor::commit_storage() {
+    // Sorted once so each cached scope is looked up in log time
+    auto stale_scopes = transaction.stale_scopes;
+    std::sort(stale_scopes.begin(), stale_scopes.end());
+
+    for (auto& [scope, slots] : storage) {
+      // Slots of wiped scopes are left to cleanstorage
+      if (std::binary_search(stale_scopes.begin(), stale_scopes.end(), scope)) {
+        continue;
+      }
+
+      account_state_table accounts_states(contract->get_self(), scope);
+      auto accounts_states_bykey = accounts_states.get_index<eosio::name("bykey")>();
+
+      for (auto& [key, slot] : slots) {
+        if (slot.value == slot.committed) {
+          continue;
+        }
 
-    // Place into original storage
-    transaction.emplace_original(address_index, key, current_value);
+        const auto checksum_key = toChecksum256(key);
+        auto account_state      = accounts_states_bykey.find(checksum_key);
+
+        // Key found
+        if (account_state != accounts_states_bykey.end())
+        {
+          if (slot.value == 0)
+          {
+            accounts_states_bykey.erase(account_state);
+          }
+          else
+          {
+            accounts_states_bykey.modify(account_state, eosio::same_payer, [&](auto& a) {
+              a.value = slot.value;
+            });
+          }
+        }
+        // Key not found and new value exists
+        else if (slot.value != 0)
+        {
+          accounts_states.emplace(transaction.ram_payer, [&](auto& a) {
+            a.index = accounts_states.available_primary_key();
+            a.key   = checksum_key;
+            a.value = slot.value;
+          });
+        }
 
-    return current_value;
+        slot.committed = slot.value;
+      }
+    }
+
+    // Scopes that only held slots written in this transaction have no rows to clean
+    stale_scope_table stale(contract->get_self(), contract->get_self().value);
+    for (const auto& scope : stale_scopes) {
+      account_state_table accounts_states(contract->get_self(), scope);
+      if (accounts_states.begin() != accounts_states.end() && stale.find(scope) == stale.end()) {
+        stale.emplace(transaction.ram_payer, [&](auto& s) {
+          s.scope = scope;
+        });
+      }
+    }
   }
 } // namespace eosio_evm
@@ -0,0 +1,63 @@
+#include <eosio.evm/eosio.evm.hpp>
+
+namespace eosio_evm {
+  // Returns code inline in the account row (legacy) or from the code table
+  const std::vector<uint8_t>& evm::get_code(const Account& account) {
+    static const std::vector<uint8_t> empty_code;
+    if (account.has_inline_code()) {
+      return account.code;
+    }
+    if (account.get_code_size() == 0) {
+      return empty_code;
+    }
+
+    auto codes_byhash = _account_codes.get_index<eosio::name("byhash")>();
+    auto existing_code = codes_byhash.find(account.code_hash.value());
+    eosio::check(existing_code != codes_byhash.end(), "code of account not found");
+    return existing_code->code;
+  }
+
+  // Adds a reference to code, storing it if no other account uses it. Returns code hash
+  eosio::checksum256 evm::add_code(const eosio::name& ram_payer, const std::vector<uint8_t>& code) {
+    const auto code_hash = eosio::checksum256(keccak_256(code));
+    if (code.empty()) {
+      return code_hash;
+    }
+
+    auto codes_byhash = _account_codes.get_index<eosio::name("byhash")>();
+    auto existing_code = codes_byhash.find(code_hash);
+    if (existing_code != codes_byhash.end()) {
+      codes_byhash.modify(existing_code, eosio::same_payer, [&](auto& c) {
+        c.refcount += 1;
+      });
+    } else {
+      _account_codes.emplace(ram_payer, [&](auto& c) {
+        c.index    = _account_codes.available_primary_key();
+        c.hash     = code_hash;
+        c.code     = code;
+        c.refcount = 1;
+      });
+    }
+
+    return code_hash;
+  }
+
+  // Drops the reference of account to its code, erasing the code once unused
+  void evm::release_code(const Account& account) {
+    if (account.has_inline_code() || account.get_code_size() == 0) {
+      return;
+    }
+
+    auto codes_byhash = _account_codes.get_index<eosio::name("byhash")>();
+    auto existing_code = codes_byhash.find(account.code_hash.value());
+    eosio::check(existing_code != codes_byhash.end(), "code of account not found, reference count is out of sync");
+
+    if (existing_code->refcount <= 1) {
+      codes_byhash.erase(existing_code);
+    } else {
+      codes_byhash.modify(existing_code, eosio::same_payer, [&](auto& c) {
+        c.refcount -= 1;
+      });
+    }
+  }
+} // namespace eosio_evm
@@ -9,74 +9,76 @@
 
 namespace eosio_evm
 {
-  // Return true if error
-  bool Processor::access_mem(const uint256_t& offset, const uint256_t& size)
+  // Narrows offset and size to 64 bits and expands memory, return true if error
+  // A zero size never touches memory, offset64 is then 0 whatever the offset
+  bool Processor::access_mem(const uint256_t& offset, const uint256_t& size, uint64_t& offset64, uint64_t& size64)
   {
-    if (size == 0) {
+    offset64 = 0;
+    size64   = 0;
+
+    if (!fits_u64(size)) {
+      return throw_error(Exception(ET::overflow, "overflow in buffer"), {});
+    }
+
+    if (size.lo.lo == 0) {
       return false;
     }
 
-    if (size > MAX_BUFFER_SIZE) {
+    if (size.lo.lo > MAX_BUFFER_SIZE || narrow_u64(offset, MAX_BUFFER_SIZE, offset64)) {
       return throw_error(Exception(ET::overflow, "overflow in buffer"), {});
     }
 
-    return prepare_mem_access(offset, static_cast<uint64_t>(size));
+    size64 = size.lo.lo;
+    return prepare_mem_access(offset64, size64);
   }
 
-    // Return true if error
-  bool Processor::prepare_mem_access(const uint256_t& offset, const uint64_t& size)
+  // Fixed size access (MLOAD, MSTORE, MSTORE8), return true if error
+  bool Processor::access_mem(const uint256_t& offset, const uint64_t& size, uint64_t& offset64)
   {
-    if (offset > MAX_BUFFER_SIZE) {
+    if (narrow_u64(offset, MAX_BUFFER_SIZE, offset64)) {
       return throw_error(Exception(ET::overflow, "overflow in buffer"), {});
     }
 
-    const auto new_size = static_cast<uint64_t>(offset) + size;
-    const auto current_size = ctx->mem.size();
+    return prepare_mem_access(offset64, size);
+  }
+
+  // Return true if error
+  bool Processor::prepare_mem_access(const uint64_t& offset, const uint64_t& size)
+  {
+    const auto new_size = offset + size;
 
-    if (new_size > current_size)
+    if (new_size > ctx->mem.size())
     {
-      const auto new_words = num_words(new_size);
-      const auto current_words = static_cast<int64_t>(current_size / 32);
-      const auto new_cost = 3 * new_words + new_words * new_words / 512;
-      const auto current_cost = 3 * current_words + current_words * current_words / 512;
-      const auto cost = new_cost - current_cost;
-
-      // Gas
-      bool error = use_gas(cost);
+      const auto new_words = static_cast<uint64_t>(num_words(new_size));
+
+      // Gas, only the words added are priced
+      bool error = use_gas(ctx->mem.expansion_cost(new_words));
       if (error) return true;
 
-      // Resize
-      const auto end = static_cast<size_t>(new_words * WORD_SIZE);
-      if (end >= MAX_MEM_SIZE) {
+      // Expand
+      if (new_words * WORD_SIZE >= MAX_MEM_SIZE) {
         return throw_error(Exception(ET::OOB, "Memory limit exceeded"), {});
       }
 
-      ctx->mem.resize(end);
+      ctx->mem.expand(new_words);
     }
 
     // Success
     return false;
   }
 
-  void Processor::calldatacopy()
+  // Common for CALLDATACOPY, CODECOPY and EXTCODECOPY
+  // Copies size bytes of src from input_index to memory, bytes past src_size are zeros
+  void Processor::copy_to_mem(const uint256_t& mem_index, const uint256_t& input_index, const uint256_t& size, const uint8_t* src, const uint64_t& src_size)
   {
-    const auto mem_index   = ctx->s.pop();
-    const auto input_index = ctx->s.pop();
-    const auto size        = ctx->s.pop();
-    if (ctx->s.stack_error) return throw_stack();
-
     // Memory access + gas cost
-    bool memory_error = access_mem(mem_index, size);
+    uint64_t destination_index, bounded_size;
+    bool memory_error = access_mem(mem_index, size, destination_index, bounded_size);
     if (memory_error) return;
 
-    // Determine destination index
-    auto destination_index = static_cast<size_t>(mem_index);
-
     // Determine source index
-    auto input_size = ctx->input.size();
-    auto bounded_size = static_cast<size_t>(size);
-    auto source_index = input_size < input_index ? input_size : static_cast<size_t>(input_index);
-    auto copy_size = std::min(bounded_size, input_size - source_index);
+    const auto source_index = saturate_u64(input_index, src_size);
+    const auto copy_size    = std::min(bounded_size, src_size - source_index);
 
     // Copy gas calculation (copy cost is 3)
     bool error = use_gas(num_words(bounded_size) * GP_COPY);
@@ -84,7 +86,7 @@ namespace eosio_evm
 
     // Set memory
     if (copy_size > 0) {
-      std::memcpy(&ctx->mem[destination_index], &ctx->input[source_index], copy_size);
+      std::memcpy(&ctx->mem[destination_index], src + source_index, copy_size);
     }
 
     if (bounded_size - copy_size > 0) {
@@ -92,44 +94,24 @@ namespace eosio_evm
     }
   }
 
-  void Processor::extcodecopy()
+  void Processor::calldatacopy()
   {
-    const auto address     = ctx->s.pop_addr();
     const auto mem_index   = ctx->s.pop();
     const auto input_index = ctx->s.pop();
     const auto size        = ctx->s.pop();
-    if (ctx->s.stack_error) return throw_stack();
-
-    // Memory access + gas cost
-    bool memory_error = access_mem(mem_index, size);
-    if (memory_error) return;
-
-    // Determine destination index
-    auto destination_index = static_cast<size_t>(mem_index);
 
-    // Determine source index
-    auto bounded_size = static_cast<size_t>(size);
-    auto source_index = MAX_BUFFER_SIZE < input_index ? MAX_BUFFER_SIZE : static_cast<size_t>(input_index);
-
-    // Copy gas calculation (copy cost is 3)
-    bool error = use_gas(num_words(bounded_size) * GP_COPY);
-    if (error) return;
-
-    // Write code to memory
-    auto code = get_account(address).get_code();
-    auto code_size = code.size();
+    copy_to_mem(mem_index, input_index, size, ctx->input.data(), ctx->input.size());
+  }
 
-    uint64_t bytes_copied = 0;
-    const auto bytes_to_copy = std::min(bounded_size, code_size - source_index);
-    if (source_index < code_size && bytes_to_copy > 0) {
-      bytes_copied = bytes_to_copy;
-      std::memcpy(&ctx->mem[destination_index], &code[source_index], bytes_to_copy);
-    }
+  void Processor::extcodecopy()
+  {
+    const auto address     = ctx->s.pop_addr();
+    const auto mem_index   = ctx->s.pop();
+    const auto input_index = ctx->s.pop();
+    const auto size        = ctx->s.pop();
 
-    // Pad zeros
-    if (bounded_size - bytes_copied > 0) {
-      std::memset(&ctx->mem[destination_index + bytes_copied], 0, bounded_size - bytes_copied);
-    }
+    const auto& code = contract->get_code(get_account(address));
+    copy_to_mem(mem_index, input_index, size, code.data(), code.size());
   }
 
   void Processor::returndatacopy()
@@ -137,28 +119,16 @@ namespace eosio_evm
     const auto mem_index   = ctx->s.pop();
     const auto input_index = ctx->s.pop();
     const auto size        = ctx->s.pop();
-    if (ctx->s.stack_error) return throw_stack();
 
     // Memory access + gas cost
-    bool memory_error = access_mem(mem_index, size);
+    uint64_t destination_index, bounded_size;
+    bool memory_error = access_mem(mem_index, size, destination_index, bounded_size);
     if (memory_error) return;
 
-    // Determine destination index
-    auto destination_index = static_cast<size_t>(mem_index);
-
-    // Validate return data
-    auto return_data_size = ctx->last_return_data.size();
-    if (return_data_size < input_index) {
-      throw_error(Exception(ET::OOB, "Invalid memory access"), {});
-      return;
-    }
-
-    // Determine source index
-    auto bounded_size = static_cast<size_t>(size);
-    auto source_index = static_cast<size_t>(input_index);
-
-    // Validate source index
-    if (source_index + bounded_size > return_data_size) {
+    // Validate source index, reading past the return data is an error
+    const auto return_data_size = ctx->last_return_data.size();
+    uint64_t source_index;
+    if (narrow_u64(input_index, return_data_size, source_index) || source_index + bounded_size > return_data_size) {
       throw_error(Exception(ET::OOB, "Invalid memory access"), {});
       return;
     }
@@ -169,7 +139,7 @@ namespace eosio_evm
 
     // Write to memory
     if (bounded_size > 0) {
-      std::memcpy(&ctx->mem[destination_index], &ctx->last_return_data[source_index], bounded_size);
+      std::memcpy(&ctx->mem[destination_index], ctx->last_return_data.data() + source_index, bounded_size);
     }
   }
 } // namespace eosio_evm
@@ -15,8 +15,7 @@ void evm::create (
   eosio::check(existing_account == accounts_byaccount.end(), "an EVM account is already linked to this EOS account.");
 
   // Encode using RLP, Hash and get right-most 160 bits (Address)
-  const auto rlp_encoding = rlp::encode(account.value, data);
-  eosio::checksum160 address_160 = toChecksum160( keccak_256(rlp_encoding) );
+  eosio::checksum160 address_160 = toChecksum160( rlp::keccak(account.value, data) );
 
   // Create user account
   auto address_256        = pad160(address_160);
@@ -24,11 +23,12 @@ void evm::create (
   auto existing_address   = accounts_byaddress.find(address_256);
   eosio::check(existing_address == accounts_byaddress.end(), "an EVM account with this address already exists.");
   _accounts.emplace(account, [&](auto& a) {
-    a.index   = _accounts.available_primary_key();
+    a.index   = next_account_index();
     a.address = address_160;
     a.nonce   = 1;
     a.account = account;
     a.balance = 0;
+    a.clear_code();
   });
 
   // Print out the address
@@ -40,9 +40,51 @@ void evm::raw(
   const std::vector<int8_t>& tx,
   const std::optional<eosio::checksum160>& sender
 ) {
-  // Create transaction
+  // Check that RAM payer is authorized
+  require_auth(ram_payer);
+
+  // Create and execute transaction
   auto transaction = EthereumTransaction(tx, ram_payer);
+  execute(transaction, sender);
+}
+
+/**
+ * Executes signed transactions in order, as a block would. Each transaction
+ * reverts on its own if execution fails, but an invalid transaction (encoding,
+ * signature, nonce or balance) fails the whole action.
+ */
+void evm::rawbatch(
+  const eosio::name& ram_payer,
+  const std::vector<std::vector<int8_t>>& txs
+) {
+  // Check that RAM payer is authorized
+  require_auth(ram_payer);
+  eosio::check(!txs.empty(), "Invalid Batch: no transactions provided.");
+
+  // Receipts are printed as a JSON array
+  uint256_t cumulative_gas_used = 0;
+  eosio::print("[");
+
+  for (uint64_t i = 0; i < txs.size(); i++) {
+    auto transaction = EthereumTransaction(txs[i], ram_payer);
+    eosio::check(!transaction.is_zero(), "Invalid Batch: transactions must be signed.");
+
+    transaction.index          = i;
+    transaction.prior_gas_used = cumulative_gas_used;
 
+    if (i > 0) eosio::print(",");
+    execute(transaction, std::nullopt);
+
+    cumulative_gas_used += transaction.gas_used;
+  }
+
+  eosio::print("]");
+}
+
+void evm::execute(
+  EthereumTransaction& transaction,
+  const std::optional<eosio::checksum160>& sender
+) {
   // Index by address
   auto accounts_byaddress = _accounts.get_index<eosio::name("byaddress")>();
   decltype(accounts_byaddress.begin()) caller;
@@ -115,6 +157,66 @@ void evm::raw(
   #endif
 }
 
+/**
+ * Processes at most "limit" accounts starting at "start_index" and
+ * prints the index to continue from if accounts remain
+ */
+void evm::migratecode(
+  const uint64_t& start_index,
+  const uint64_t& limit
+) {
+  require_auth(get_self());
+
+  auto itr = _accounts.lower_bound(start_index);
+  for (uint64_t i = 0; i < limit && itr != _accounts.end(); i++, itr++) {
+    if (itr->has_inline_code()) {
+      const auto code_hash = add_code(get_self(), itr->code);
+      _accounts.modify(itr, eosio::same_payer, [&](auto& a) {
+        a.set_code_ref(code_hash, a.code.size());
+      });
+    } else if (!itr->code_hash.has_value() || !itr->code_size.has_value()) {
+      _accounts.modify(itr, eosio::same_payer, [&](auto& a) {
+        a.clear_code();
+      });
+    }
+  }
+
+  if (itr != _accounts.end()) {
+    eosio::print(itr->index);
+  }
+}
+
+/**
+ * Erases at most "limit" rows of stale storage scopes and
+ * prints the scope to continue from if stale scopes remain
+ */
+void evm::cleanstorage(
+  const uint64_t& limit
+) {
+  stale_scope_table stale(get_self(), get_self().value);
+
+  uint64_t erased = 0;
+  auto itr = stale.begin();
+  while (itr != stale.end() && erased < limit) {
+    account_state_table accounts_states(get_self(), itr->scope);
+    auto state = accounts_states.begin();
+    while (state != accounts_states.end() && erased < limit) {
+      state = accounts_states.erase(state);
+      erased++;
+    }
+
+    // Scope is only forgotten once empty
+    if (state != accounts_states.end()) {
+      break;
+    }
+    itr = stale.erase(itr);
+  }
+
+  if (itr != stale.end()) {
+    eosio::print(itr->scope);
+  }
+}
+
 /**
  * Will always assert, replicates Ethereum Call functionality
  */
@@ -123,6 +225,9 @@ void evm::call(
   const std::vector<int8_t>& tx,
   const std::optional<eosio::checksum160>& sender
 ) {
+  // Check that RAM payer is authorized
+  require_auth(ram_payer);
+
   auto transaction = EthereumTransaction(tx, ram_payer);
 
   // Find caller
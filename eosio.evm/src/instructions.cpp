@@ -12,6 +12,97 @@
 
 namespace eosio_evm
 {
+  #if (DISPATCH_TABLE == true)
+  using Handler = void (Processor::*)();
+
+  // Handler for every opcode, undefined opcodes are illegal
+  static constexpr std::array<Handler, 256> make_handler_table()
+  {
+    std::array<Handler, 256> table = {};
+    for (auto& handler : table) handler = &Processor::illegal;
+    for (auto op = uint16_t(Opcode::PUSH1); op <= Opcode::PUSH32; op++) table[op] = &Processor::push;
+    table[Opcode::POP] = &Processor::pop;
+    for (auto op = uint16_t(Opcode::SWAP1); op <= Opcode::SWAP16; op++) table[op] = &Processor::swap;
+    for (auto op = uint16_t(Opcode::DUP1); op <= Opcode::DUP16; op++) table[op] = &Processor::dup;
+    for (auto op = uint16_t(Opcode::LOG0); op <= Opcode::LOG4; op++) table[op] = &Processor::log;
+    table[Opcode::ADD] = &Processor::add;
+    table[Opcode::MUL] = &Processor::mul;
+    table[Opcode::SUB] = &Processor::sub;
+    table[Opcode::DIV] = &Processor::div;
+    table[Opcode::SDIV] = &Processor::sdiv;
+    table[Opcode::MOD] = &Processor::mod;
+    table[Opcode::SMOD] = &Processor::smod;
+    table[Opcode::ADDMOD] = &Processor::addmod;
+    table[Opcode::MULMOD] = &Processor::mulmod;
+    table[Opcode::EXP] = &Processor::exp;
+    table[Opcode::SIGNEXTEND] = &Processor::signextend;
+    table[Opcode::LT] = &Processor::lt;
+    table[Opcode::GT] = &Processor::gt;
+    table[Opcode::SLT] = &Processor::slt;
+    table[Opcode::SGT] = &Processor::sgt;
+    table[Opcode::EQ] = &Processor::eq;
+    table[Opcode::ISZERO] = &Processor::isZero;
+    table[Opcode::AND] = &Processor::and_;
+    table[Opcode::OR] = &Processor::or_;
+    table[Opcode::XOR] = &Processor::xor_;
+    table[Opcode::NOT] = &Processor::not_;
+    table[Opcode::BYTE] = &Processor::byte;
+    table[Opcode::SHL] = &Processor::shl;
+    table[Opcode::SHR] = &Processor::shr;
+    table[Opcode::SAR] = &Processor::sar;
+    table[Opcode::JUMP] = &Processor::jump;
+    table[Opcode::JUMPI] = &Processor::jumpi;
+    table[Opcode::PC] = &Processor::pc;
+    table[Opcode::MSIZE] = &Processor::msize;
+    table[Opcode::MLOAD] = &Processor::mload;
+    table[Opcode::MSTORE] = &Processor::mstore;
+    table[Opcode::MSTORE8] = &Processor::mstore8;
+    table[Opcode::CODESIZE] = &Processor::codesize;
+    table[Opcode::CODECOPY] = &Processor::codecopy;
+    table[Opcode::EXTCODESIZE] = &Processor::extcodesize;
+    table[Opcode::EXTCODECOPY] = &Processor::extcodecopy;
+    table[Opcode::SLOAD] = &Processor::sload;
+    table[Opcode::SSTORE] = &Processor::sstore;
+    table[Opcode::ADDRESS] = &Processor::address;
+    table[Opcode::BALANCE] = &Processor::balance;
+    table[Opcode::ORIGIN] = &Processor::origin;
+    table[Opcode::CALLER] = &Processor::caller;
+    table[Opcode::CALLVALUE] = &Processor::callvalue;
+    table[Opcode::CALLDATALOAD] = &Processor::calldataload;
+    table[Opcode::CALLDATASIZE] = &Processor::calldatasize;
+    table[Opcode::CALLDATACOPY] = &Processor::calldatacopy;
+    table[Opcode::RETURNDATASIZE] = &Processor::returndatasize;
+    table[Opcode::RETURNDATACOPY] = &Processor::returndatacopy;
+    table[Opcode::EXTCODEHASH] = &Processor::extcodehash;
+    table[Opcode::RETURN] = &Processor::return_;
+    table[Opcode::SELFDESTRUCT] = &Processor::selfdestruct;
+    table[Opcode::CREATE] = &Processor::create;
+    table[Opcode::CREATE2] = &Processor::create;
+    table[Opcode::CALL] = &Processor::call;
+    table[Opcode::STATICCALL] = &Processor::call;
+    table[Opcode::CALLCODE] = &Processor::call;
+    table[Opcode::DELEGATECALL] = &Processor::call;
+    table[Opcode::JUMPDEST] = &Processor::jumpdest;
+    table[Opcode::BLOCKHASH] = &Processor::blockhash;
+    table[Opcode::NUMBER] = &Processor::number;
+    table[Opcode::GASPRICE] = &Processor::gasprice;
+    table[Opcode::COINBASE] = &Processor::coinbase;
+    table[Opcode::TIMESTAMP] = &Processor::timestamp;
+    table[Opcode::DIFFICULTY] = &Processor::difficulty;
+    table[Opcode::GASLIMIT] = &Processor::gaslimit;
+    table[Opcode::CHAINID] = &Processor::chainid;
+    table[Opcode::SELFBALANCE] = &Processor::selfbalance;
+    table[Opcode::GAS] = &Processor::gas;
+    table[Opcode::SHA3] = &Processor::sha3;
+    table[Opcode::STOP] = &Processor::stop;
+    table[Opcode::INVALID] = &Processor::invalid;
+    table[Opcode::REVERT] = &Processor::revert;
+    return table;
+  }
+
+  static constexpr auto handler_table = make_handler_table();
+  #endif /* DISPATCH_TABLE */
+
   void Processor::dispatch()
   {
     const auto op = get_op();
@@ -34,10 +125,17 @@ namespace eosio_evm
     // eosio::print("\nMem Pages: ", __builtin_wasm_current_memory());
     #endif /* OPTRACE */
 
-    // Charge gas
-    bool error = use_gas(OpFees::by_code[op]);
-    if (error) return;
+    // Charge gas and validate stack for the whole basic block on entry,
+    // handlers below use unchecked stack access
+    const auto block = ctx->get_instr().block;
+    if (block != NO_BLOCK) {
+      bool error = begin_block(ctx->prog->blocks[block]);
+      if (error) return;
+    }
 
+    #if (DISPATCH_TABLE == true)
+    (this->*handler_table[op])();
+    #else
     switch (op)
     {
       case Opcode::PUSH1 ... Opcode::PUSH32:
@@ -267,6 +365,7 @@ namespace eosio_evm
         illegal();
         break;
     };
+    #endif /* DISPATCH_TABLE */
   }
 
   /**
@@ -274,34 +373,48 @@ namespace eosio_evm
    */
   void Processor::stop()
   {
-    const auto success_cb = ctx->success_cb;
+    const auto cont = ctx->cont;
     const auto gas_used = ctx->gas_used();
     pop_context();
-    success_cb({}, gas_used);
+    resume(cont, nullptr, {}, gas_used);
   }
 
+  // ADD, MUL, SUB, LT, GT and EQ take a scalar path when both operands fit in 64 bits
   void Processor::add()
   {
     const auto x = ctx->s.pop();
     const auto y = ctx->s.pop();
-    ctx->s.push(x + y);
-    if (ctx->s.stack_error) return throw_stack();
+
+    if (fits_u64(x | y)) {
+      const auto sum = x.lo.lo + y.lo.lo;
+      ctx->s.push(uint256_t{ 0, intx::uint128{ sum < x.lo.lo, sum } });
+    } else {
+      ctx->s.push(x + y);
+    }
   }
 
   void Processor::mul()
   {
     const auto x = ctx->s.pop();
     const auto y = ctx->s.pop();
-    ctx->s.push(x * y);
-    if (ctx->s.stack_error) return throw_stack();
+
+    if (fits_u64(x | y)) {
+      ctx->s.push(uint256_t{ 0, intx::umul(x.lo.lo, y.lo.lo) });
+    } else {
+      ctx->s.push(x * y);
+    }
   }
 
   void Processor::sub()
   {
     const auto x = ctx->s.pop();
     const auto y = ctx->s.pop();
-    ctx->s.push(x - y);
-    if (ctx->s.stack_error) return throw_stack();
+
+    if (fits_u64(x | y) && x.lo.lo >= y.lo.lo) {
+      ctx->s.push(x.lo.lo - y.lo.lo);
+    } else {
+      ctx->s.push(x - y);
+    }
   }
 
   void Processor::div()
@@ -313,7 +426,6 @@ namespace eosio_evm
     } else {
       ctx->s.push(x / y);
     }
-    if (ctx->s.stack_error) return throw_stack();
   }
 
   void Processor::sdiv()
@@ -329,8 +441,6 @@ namespace eosio_evm
       ctx->s.push(x);
     else
       ctx->s.push(intx::sdivrem(x, y).quot);
-
-    if (ctx->s.stack_error) return throw_stack();
   }
 
   void Processor::mod()
@@ -342,8 +452,6 @@ namespace eosio_evm
       ctx->s.push(0);
     else
       ctx->s.push(x % m);
-
-    if (ctx->s.stack_error) return throw_stack();
   }
 
   void Processor::addmod()
@@ -356,8 +464,6 @@ namespace eosio_evm
       ctx->s.push(0);
     else
       ctx->s.push(intx::addmod(x, y, m));
-
-    if (ctx->s.stack_error) return throw_stack();
   }
 
   void Processor::smod()
@@ -369,8 +475,6 @@ namespace eosio_evm
       ctx->s.push(0);
     else
       ctx->s.push(intx::sdivrem(x, m).rem);
-
-    if (ctx->s.stack_error) return throw_stack();
   }
 
   void Processor::mulmod()
@@ -383,20 +487,83 @@ namespace eosio_evm
       ctx->s.push(0);
     else
       ctx->s.push(intx::mulmod(x, y, m));
+  }
 
-    if (ctx->s.stack_error) return throw_stack();
+  // Square and multiply over a 64 bit exponent
+  static uint256_t exp_small(uint256_t base, uint64_t exponent)
+  {
+    uint256_t result = 1;
+    while (true) {
+      if (exponent & 1) {
+        result *= base;
+      }
+      exponent >>= 1;
+      if (exponent == 0) {
+        return result;
+      }
+      base *= base;
+    }
+  }
+
+  // Left to right sliding window (4 bits) over a 256 bit exponent, which must not be 0
+  static uint256_t exp_window(const uint256_t& base, const uint256_t& exponent)
+  {
+    const uint64_t words[4] = { exponent.lo.lo, exponent.lo.hi, exponent.hi.lo, exponent.hi.hi };
+    const auto bit = [&](const int i) { return static_cast<unsigned>(words[i / 64] >> (i % 64)) & 1; };
+
+    // Odd powers base^1, base^3, ..., base^15
+    uint256_t odd[8];
+    odd[0] = base;
+    const auto square = base * base;
+    for (int i = 1; i < 8; i++) {
+      odd[i] = odd[i - 1] * square;
+    }
+
+    uint256_t result = 1;
+    bool started = false;
+    int i = 255 - static_cast<int>(intx::clz(exponent));
+    while (i >= 0) {
+      if (bit(i) == 0) {
+        result *= result;
+        i--;
+        continue;
+      }
+
+      // Longest window ending in a set bit
+      int j = std::max(i - 3, 0);
+      while (bit(j) == 0) {
+        j++;
+      }
+
+      unsigned window = 0;
+      for (int k = i; k >= j; k--) {
+        window = (window << 1) | bit(k);
+      }
+
+      if (started) {
+        for (int k = i; k >= j; k--) {
+          result *= result;
+        }
+        result *= odd[window >> 1];
+      } else {
+        result = odd[window >> 1];
+        started = true;
+      }
+
+      i = j - 1;
+    }
+
+    return result;
   }
 
   void Processor::exp()
   {
     const auto b = ctx->s.pop();
     const auto e = ctx->s.pop();
-    if (ctx->s.stack_error) return throw_stack();
 
     // Optimize: X^0 = 1
     if (e == 0) {
       ctx->s.push(1);
-      if (ctx->s.stack_error) return throw_stack();
       return;
     }
 
@@ -405,21 +572,33 @@ namespace eosio_evm
     bool error = use_gas(sig_bytes * GP_EXP_BYTE);
     if (error) return;
 
+    // Optimize: 0^X = 0 and (2^K)^X = 2^(K*X), 0 once K*X reaches 256
+    if (b == 0) {
+      ctx->s.push(0);
+      return;
+    }
+    if ((b & (b - 1)) == 0) {
+      const auto k = 255 - intx::clz(b);
+      if (k == 0 || (fits_u64(e) && e.lo.lo < 256 && k * e.lo.lo < 256)) {
+        ctx->s.push(uint256_t{1} << static_cast<unsigned>(k * e.lo.lo));
+      } else {
+        ctx->s.push(0);
+      }
+      return;
+    }
+
     // Push result
-    const auto res = intx::exp(b, uint256_t(e));
+    const auto res = fits_u64(e) ? exp_small(b, e.lo.lo) : exp_window(b, e);
     ctx->s.push(res);
-    if (ctx->s.stack_error) return throw_stack();
   }
 
   void Processor::signextend()
   {
     const auto ext = ctx->s.pop();
     const auto x = ctx->s.pop();
-    if (ctx->s.stack_error) return throw_stack();
 
     if (ext >= 32) {
       ctx->s.push(x);
-      if (ctx->s.stack_error) return throw_stack();
       return;
     }
 
@@ -428,23 +607,30 @@ namespace eosio_evm
     const auto value_mask = sign_mask - 1;
     const auto is_neg = (x & sign_mask) != 0;
     ctx->s.push(is_neg ? x | ~value_mask : x & value_mask);
-    if (ctx->s.stack_error) return throw_stack();
   }
 
   void Processor::lt()
   {
     const auto x = ctx->s.pop();
     const auto y = ctx->s.pop();
-    ctx->s.push(x < y);
-    if (ctx->s.stack_error) return throw_stack();
+
+    if (fits_u64(x | y)) {
+      ctx->s.push(x.lo.lo < y.lo.lo);
+    } else {
+      ctx->s.push(x < y);
+    }
   }
 
   void Processor::gt()
   {
     const auto x = ctx->s.pop();
     const auto y = ctx->s.pop();
-    ctx->s.push(x > y);
-    if (ctx->s.stack_error) return throw_stack();
+
+    if (fits_u64(x | y)) {
+      ctx->s.push(x.lo.lo > y.lo.lo);
+    } else {
+      ctx->s.push(x > y);
+    }
   }
 
   void Processor::slt()
@@ -455,13 +641,11 @@ namespace eosio_evm
     auto x_neg = static_cast<bool>(x >> 255);
     auto y_neg = static_cast<bool>(y >> 255);
     ctx->s.push((x_neg ^ y_neg) ? x_neg : x < y);
-    if (ctx->s.stack_error) return throw_stack();
   }
 
   void Processor::sgt()
   {
     ctx->s.swap(1);
-    if (ctx->s.stack_error) return throw_stack();
     slt();
   }
 
@@ -469,15 +653,18 @@ namespace eosio_evm
   {
     const auto x = ctx->s.pop();
     const auto y = ctx->s.pop();
-    ctx->s.push(x == y);
-    if (ctx->s.stack_error) return throw_stack();
+
+    if (fits_u64(x | y)) {
+      ctx->s.push(x.lo.lo == y.lo.lo);
+    } else {
+      ctx->s.push(x == y);
+    }
   }
 
   void Processor::isZero()
   {
     const auto x = ctx->s.pop();
     ctx->s.push(x == 0);
-    if (ctx->s.stack_error) return throw_stack();
   }
 
   void Processor::and_()
@@ -485,7 +672,6 @@ namespace eosio_evm
     const auto x = ctx->s.pop();
     const auto y = ctx->s.pop();
     ctx->s.push(x & y);
-    if (ctx->s.stack_error) return throw_stack();
   }
 
   void Processor::or_()
@@ -493,7 +679,6 @@ namespace eosio_evm
     const auto x = ctx->s.pop();
     const auto y = ctx->s.pop();
     ctx->s.push(x | y);
-    if (ctx->s.stack_error) return throw_stack();
   }
 
   void Processor::xor_()
@@ -501,14 +686,12 @@ namespace eosio_evm
     const auto x = ctx->s.pop();
     const auto y = ctx->s.pop();
     ctx->s.push(x ^ y);
-    if (ctx->s.stack_error) return throw_stack();
   }
 
   void Processor::not_()
   {
     const auto x = ctx->s.pop();
     ctx->s.push(~x);
-    if (ctx->s.stack_error) return throw_stack();
   }
 
   void Processor::byte()
@@ -524,7 +707,6 @@ namespace eosio_evm
       auto y = x >> sh;
       ctx->s.push(y & 0xff);
     }
-    if (ctx->s.stack_error) return throw_stack();
   }
 
   void Processor::shl()
@@ -532,7 +714,6 @@ namespace eosio_evm
     const auto shift = ctx->s.pop();
     const auto value = ctx->s.pop();
     ctx->s.push(value << shift);
-    if (ctx->s.stack_error) return throw_stack();
   }
 
   void Processor::shr()
@@ -540,7 +721,6 @@ namespace eosio_evm
     const auto shift = ctx->s.pop();
     const auto value = ctx->s.pop();
     ctx->s.push(value >> shift);
-    if (ctx->s.stack_error) return throw_stack();
   }
 
   void Processor::sar()
@@ -550,7 +730,6 @@ namespace eosio_evm
 
     if ((value & (uint256_t{1} << 255)) == 0) {
       ctx->s.push(value >> shift);
-      if (ctx->s.stack_error) return throw_stack();
       return;
     }
 
@@ -560,35 +739,38 @@ namespace eosio_evm
     } else {
       ctx->s.push((value >> shift) | (ones << (256 - shift)));
     }
-    if (ctx->s.stack_error) return throw_stack();
   }
 
   void Processor::sha3()
   {
     const auto offset = ctx->s.pop();
     const auto size = ctx->s.pop();
-    if (ctx->s.stack_error) return throw_stack();
 
     // Memory acess + gas
-    bool memory_error = access_mem(offset, size);
+    uint64_t o, s;
+    bool memory_error = access_mem(offset, size, o, s);
     if (memory_error) return;
 
     // Update gas (ceiling)
-    bool gas_error = use_gas(num_words(static_cast<uint64_t>(size)) * GP_SHA3_WORD);
+    bool gas_error = use_gas(num_words(s) * GP_SHA3_WORD);
     if (gas_error) return;
 
+    // Mapping slots (key . slot) repeat within a transaction
+    if (s == 64) {
+      ctx->s.push(sha3_memo.hash(ctx->mem.data() + o));
+      return;
+    }
+
     // Find keccak 256 hash
     uint8_t h[32];
-    keccak_256(ctx->mem.data() + static_cast<uint64_t>(offset), static_cast<unsigned int>(size), h);
+    keccak_256(ctx->mem.data() + o, s, h);
 
     ctx->s.push(intx::be::load<uint256_t>(h));
-    if (ctx->s.stack_error) return throw_stack();
   }
 
   void Processor::address()
   {
     ctx->s.push(ctx->callee.get_address());
-    if (ctx->s.stack_error) return throw_stack();
   }
 
   void Processor::balance()
@@ -597,26 +779,22 @@ namespace eosio_evm
 
     const Account& given_account = get_account(address);
     ctx->s.push(given_account.get_balance());
-    if (ctx->s.stack_error) return throw_stack();
   }
 
   void Processor::origin()
   {
     const auto address = checksum160ToAddress(*transaction.sender);
     ctx->s.push(address);
-    if (ctx->s.stack_error) return throw_stack();
   }
 
   void Processor::caller()
   {
     ctx->s.push(ctx->caller.get_address());
-    if (ctx->s.stack_error) return throw_stack();
   }
 
   void Processor::callvalue()
   {
     ctx->s.push(ctx->call_value);
-    if (ctx->s.stack_error) return throw_stack();
   }
 
   void Processor::calldataload()
@@ -624,12 +802,12 @@ namespace eosio_evm
     const auto index = ctx->s.pop();
 
     const auto input_size = ctx->input.size();
+    const auto begin      = saturate_u64(index, input_size);
 
-    if (input_size < index)
+    if (begin == input_size)
       ctx->s.push(0);
     else
     {
-      const auto begin = static_cast<size_t>(index);
       const auto end = std::min(begin + 32, input_size);
 
       uint8_t data[32] = {};
@@ -639,19 +817,16 @@ namespace eosio_evm
 
       ctx->s.push(intx::be::load<uint256_t>(data));
     }
-    if (ctx->s.stack_error) return throw_stack();
   }
 
   void Processor::calldatasize()
   {
     ctx->s.push(ctx->input.size());
-    if (ctx->s.stack_error) return throw_stack();
   }
 
   void Processor::codesize()
   {
-    ctx->s.push(ctx->prog.code.size());
-    if (ctx->s.stack_error) return throw_stack();
+    ctx->s.push(ctx->prog->code.size());
   }
 
   void Processor::codecopy()
@@ -659,53 +834,31 @@ namespace eosio_evm
     const auto mem_index = ctx->s.pop();
     const auto input_index = ctx->s.pop();
     const auto size = ctx->s.pop();
-    if (ctx->s.stack_error) return throw_stack();
 
-    bool memory_error = access_mem(mem_index, size);
-    if (memory_error) return;
-
-    const auto code_size = ctx->prog.code.size();
-    auto dst = static_cast<size_t>(mem_index);
-    auto src = (code_size < input_index) ? code_size : static_cast<size_t>(input_index);
-    auto s = static_cast<size_t>(size);
-    auto copy_size = std::min(s, code_size - src);
-
-    // Gas cost
-    bool gas_error = use_gas((num_words(s) * GP_COPY));
-    if (gas_error) return;
-
-    if (copy_size > 0)
-        std::memcpy(&ctx->mem[dst], &ctx->prog.code[src], copy_size);
-
-    if (s - copy_size > 0)
-        std::memset(&ctx->mem[dst + copy_size], 0, s - copy_size);
+    const auto& code = ctx->prog->code;
+    copy_to_mem(mem_index, input_index, size, code.data(), code.size());
   }
 
   void Processor::gasprice()
   {
     ctx->s.push(transaction.gas_price);
-    if (ctx->s.stack_error) return throw_stack();
   }
 
   void Processor::extcodesize()
   {
     auto address = ctx->s.pop_addr();
 
-    auto code = get_account(address).get_code();
-    ctx->s.push(code.size());
-    if (ctx->s.stack_error) return throw_stack();
+    ctx->s.push(get_account(address).get_code_size());
   }
 
   void Processor::returndatasize()
   {
     ctx->s.push(ctx->last_return_data.size());
-    if (ctx->s.stack_error) return throw_stack();
   }
 
   void Processor::extcodehash()
   {
     auto address = ctx->s.pop_addr();
-    if (ctx->s.stack_error) return throw_stack();
 
     // Fetch code account
     const Account& code_account = get_account(address);
@@ -713,126 +866,103 @@ namespace eosio_evm
     // If account is empty, return 0
     if (code_account.is_empty()) {
       ctx->s.push(0);
-      if (ctx->s.stack_error) return throw_stack();
       return;
     }
 
-    // Get account code
-    auto code = code_account.get_code();
-
-    // Hash code
-    uint8_t h[32];
-    keccak_256(code.data(), code.size(), h);
-
-    ctx->s.push(intx::be::load<uint256_t>(h));
+    ctx->s.push(code_account.get_code_hash());
   }
 
   void Processor::blockhash()
   {
     const auto i = ctx->s.pop();
-    if (ctx->s.stack_error) return throw_stack();
 
     if (i >= 256)
       ctx->s.push(0);
     else
       ctx->s.push(get_block_hash(static_cast<uint8_t>(i % 256)));
-    if (ctx->s.stack_error) return throw_stack();
   }
 
   void Processor::coinbase()
   {
     ctx->s.push(get_current_block().coinbase);
-    if (ctx->s.stack_error) return throw_stack();
   }
 
   void Processor::timestamp()
   {
     ctx->s.push(get_current_block().timestamp);
-    if (ctx->s.stack_error) return throw_stack();
   }
 
   void Processor::number()
   {
     ctx->s.push(get_current_block().number);
-    if (ctx->s.stack_error) return throw_stack();
   }
 
   void Processor::difficulty()
   {
     ctx->s.push(get_current_block().difficulty);
-    if (ctx->s.stack_error) return throw_stack();
   }
 
   void Processor::gaslimit()
   {
     ctx->s.push(get_current_block().gas_limit);
-    if (ctx->s.stack_error) return throw_stack();
   }
 
   void Processor::chainid()
   {
     ctx->s.push(CURRENT_CHAIN_ID);
-    if (ctx->s.stack_error) return throw_stack();
   }
 
   void Processor::selfbalance()
   {
     ctx->s.push(ctx->callee.get_balance());
-    if (ctx->s.stack_error) return throw_stack();
   }
 
   void Processor::pop()
   {
     ctx->s.pop();
-    if (ctx->s.stack_error) return throw_stack();
   }
 
   void Processor::mload()
   {
     const auto offset = ctx->s.pop();
-    if (ctx->s.stack_error) return throw_stack();
 
-    bool error = access_mem(offset, WORD_SIZE);
+    uint64_t o;
+    bool error = access_mem(offset, WORD_SIZE, o);
     if (error) return;
 
-    auto res = intx::be::unsafe::load<uint256_t>(&ctx->mem[static_cast<uint64_t>(offset)]);
-
-    ctx->s.push(res);
-    if (ctx->s.stack_error) return throw_stack();
+    ctx->s.push(ctx->mem.load_word(o));
   }
 
   void Processor::mstore()
   {
     const auto offset = ctx->s.pop();
     const auto word = ctx->s.pop();
-    if (ctx->s.stack_error) return throw_stack();
 
-    bool error = access_mem(offset, WORD_SIZE);
+    uint64_t o;
+    bool error = access_mem(offset, WORD_SIZE, o);
     if (error) return;
 
-    intx::be::unsafe::store(&ctx->mem[static_cast<size_t>(offset)], word);
+    ctx->mem.store_word(o, word);
   }
 
   void Processor::mstore8()
   {
     const auto offset = ctx->s.pop();
     const auto byte = ctx->s.pop();
-    if (ctx->s.stack_error) return throw_stack();
 
-    bool error = access_mem(offset, 1);
+    uint64_t o;
+    bool error = access_mem(offset, 1, o);
     if (error) return;
 
-    ctx->mem[static_cast<size_t>(offset)] = static_cast<uint8_t>(byte);
+    ctx->mem.store_byte(o, static_cast<uint8_t>(byte));
   }
 
   void Processor::sload()
   {
     const auto k = ctx->s.pop();
-    if (ctx->s.stack_error) return throw_stack();
-    uint256_t loaded = loadkv(ctx->callee.primary_key(), k);
+    const auto& slot = loadkv(ctx->callee.get_storage_scope(), k);
 
-    ctx->s.push(loaded);
-    if (ctx->s.stack_error) return throw_stack();
+    ctx->s.push(slot.value);
   }
 
   void Processor::sstore()
@@ -849,24 +979,22 @@ namespace eosio_evm
     // Get items from stack
     const auto k = ctx->s.pop();
     const auto v = ctx->s.pop();
-    if (ctx->s.stack_error) return throw_stack();
 
     // Load current value
-    uint256_t current_value = loadkv(ctx->callee.primary_key(), k);
+    const auto scope = ctx->callee.get_storage_scope();
+    auto& slot = loadkv(scope, k);
 
     // Charge gas
-    auto original_value = transaction.find_original(ctx->callee.primary_key(), k);
-    bool error = process_sstore_gas(original_value, current_value, v);
+    bool error = process_sstore_gas(slot.committed, slot.value, v);
     if (error) return;
 
     // Store
-    storekv(ctx->callee.primary_key(), k, v);
+    storekv(scope, k, slot, v);
   }
 
   void Processor::jump()
   {
     const auto newPc = ctx->s.pop();
-    if (ctx->s.stack_error) return throw_stack();
 
     bool error = jump_to(newPc);
     if (error) return;
@@ -876,7 +1004,6 @@ namespace eosio_evm
   {
     const auto newPc = ctx->s.pop();
     const auto cond = ctx->s.pop();
-    if (ctx->s.stack_error) return throw_stack();
 
     if (cond) {
       bool error = jump_to(newPc);
@@ -887,59 +1014,33 @@ namespace eosio_evm
   void Processor::pc()
   {
     ctx->s.push(ctx->get_pc());
-    if (ctx->s.stack_error) return throw_stack();
   }
 
   void Processor::msize()
   {
     ctx->s.push(ctx->get_used_mem() * 32);
-    if (ctx->s.stack_error) return throw_stack();
   }
 
   void Processor::gas()
   {
     ctx->s.push(ctx->gas_left);
-    if (ctx->s.stack_error) return throw_stack();
   }
 
   void Processor::jumpdest() {}
 
   void Processor::push()
   {
-    const uint8_t bytes = get_op() - PUSH1 + 1;
-    const auto end = ctx->get_pc() + bytes;
-
-    if (end < ctx->get_pc()) {
-      throw_error(Exception(ET::OOB, "Integer overflow in push"), {});
-      return;
-    }
-    if (end >= ctx->prog.code.size()) {
-      stop();
-      return;
-    }
-
-    // TODO: parse immediate once and not every time
-    auto pc = ctx->get_pc() + 1;
-    uint256_t imm = 0;
-    for (int i = 0; i < bytes; i++) {
-      imm = (imm << 8) | ctx->prog.code[pc++];
-    }
-
-    ctx->s.push(imm);
-    if (ctx->s.stack_error) return throw_stack();
-    ctx->set_pc(pc);
+    ctx->s.push(ctx->prog->push_values[ctx->get_instr().arg]);
   }
 
   void Processor::dup()
   {
     ctx->s.dup(get_op() - DUP1);
-    if (ctx->s.stack_error) return throw_stack();
   }
 
   void Processor::swap()
   {
     ctx->s.swap(get_op() - SWAP1 + 1);
-    if (ctx->s.stack_error) return throw_stack();
   }
 
   void Processor::log()
@@ -952,38 +1053,33 @@ namespace eosio_evm
     // Pop initial
     const auto offset = ctx->s.pop();
     const auto size = ctx->s.pop();
-    if (ctx->s.stack_error) return throw_stack();
 
     // Memory access
-    bool memory_error = access_mem(offset, size);
+    uint64_t o, s;
+    bool memory_error = access_mem(offset, size, o, s);
     if (memory_error) return;
 
-    // Bound size
-    const auto o = static_cast<size_t>(offset);
-    const auto s = static_cast<size_t>(size);
-
     // Number of logs
     const uint8_t num_topics = get_op() - LOG0;
 
     // Gas
-    bool gas_error = use_gas((size * GP_LOG_DATA) + (num_topics * GP_EXTRA_PER_LOG));
+    bool gas_error = use_gas((s * GP_LOG_DATA) + (num_topics * GP_EXTRA_PER_LOG));
     if (gas_error) return;
 
     // POP logs
     std::vector<uint256_t> topics (num_topics);
     for (size_t i = 0; i < num_topics; ++i) {
       auto log = ctx->s.pop();
-      if (ctx->s.stack_error) return throw_stack();
 
       topics[i] = log;
     }
 
     #if (PRINT_LOGS == true)
-      if (size != 0) {
+      if (s != 0) {
         const auto& data = std::vector<uint8_t>(ctx->mem.begin() + o, ctx->mem.begin() + o + s);
         LogEntry log ({ ctx->callee.get_address(), std::move(data), topics });
         transaction.logs.logs.emplace_back(std::move(log));
-        transaction.add_modification({ SMT::LOG, 0, 0, 0, 0, 0 });
+        transaction.state_modifications.add(SMT::LOG);
       }
     #endif
   }
@@ -1013,18 +1109,18 @@ namespace eosio_evm
     const auto offset         = ctx->s.pop();
     const auto size           = ctx->s.pop();
     const auto arbitrary      = op == CREATE2 ? ctx->s.pop() : ctx->callee.get_nonce();
-    if (ctx->s.stack_error) return throw_stack();
 
     // Find init code
-    bool memory_error = access_mem(offset, size);
+    uint64_t o, s;
+    bool memory_error = access_mem(offset, size, o, s);
     if (memory_error) return;
 
     // Check max
-    const std::vector<uint8_t> init_code = { &ctx->mem[size_t(offset)], &ctx->mem[size_t(offset)] + size_t(size) };
+    std::vector<uint8_t> init_code(ctx->mem.begin() + o, ctx->mem.begin() + o + s);
 
     // Extra gas cast for CREATE2
     if (op == CREATE2) {
-      bool error = use_gas(num_words(size_t(size)) * GP_SHA3_WORD);
+      bool error = use_gas(num_words(s) * GP_SHA3_WORD);
       if (error) return;
     }
 
@@ -1037,14 +1133,13 @@ namespace eosio_evm
     const auto gas_limit = ctx->gas_left - (ctx->gas_left / 64);
 
     // Clear return data
-    ctx->last_return_data.clear();
+    ctx->last_return_data = {};
 
     // Depth and balance Validation
     bool max_call_depth = get_call_depth() > MAX_CALL_DEPTH;
     bool insufficient_balance = ctx->callee.get_balance() < contract_value;
     if (max_call_depth || insufficient_balance) {
       ctx->s.push(0);
-      if (ctx->s.stack_error) return throw_stack();
       return;
     }
 
@@ -1064,7 +1159,6 @@ namespace eosio_evm
     auto [new_account, error] = create_account(new_address, true);
     if (error) {
       ctx->s.push(0);
-      if (ctx->s.stack_error) return throw_stack();
       use_gas(gas_limit); // Collisions are full exceptions
       return;
     }
@@ -1073,57 +1167,14 @@ namespace eosio_evm
     bool transfer_error = transfer_internal(ctx->callee.get_address(), new_account.get_address(), contract_value);
     if (transfer_error) {
       ctx->s.push(0);
-      if (ctx->s.stack_error) return throw_stack();
       return;
     }
 
-    // Initial refunds
-    const auto old_refunds = transaction.gas_refunds;
-
     // Execute new account's code
-    auto p_ctx = ctx;
-    auto new_account_address = new_account.get_address();
-
-    auto success_cb = [&, p_ctx, new_account_address, gas_limit](const std::vector<uint8_t>& output, const uint256_t& sub_gas_used) {
-      auto create_data_gas = output.size() * GP_CREATE_DATA;
-      auto total_sub_gas = sub_gas_used + create_data_gas;
-
-      // Error
-      if (total_sub_gas > gas_limit) {
-        bool gas_error = use_gas(gas_limit);
-        if (gas_error) return;
-
-        p_ctx->s.push(0);
-        if (ctx->s.stack_error) return throw_stack();
-        return;
-      }
-
-      // Charge gas
-      bool gas_error = use_gas(total_sub_gas);
-      if (gas_error) return;
-
-      // Set code
-      set_code(new_account_address, move(output));
-
-      // Push created address on stack
-      p_ctx->s.push(new_account_address);
-      if (p_ctx->s.stack_error) return throw_stack();
-    };
-    auto error_cb = [&, p_ctx, old_refunds](const Exception& ex_, const std::vector<uint8_t>& output, const uint256_t& sub_gas_used) {
-      // Set return data if revert
-      if (ex_.type == ET::revert) {
-        p_ctx->last_return_data = output;
-      }
-
-      p_ctx->s.push(0);
-      if (p_ctx->s.stack_error) return throw_stack();
-
-      // Reset refunds
-      transaction.gas_refunds = old_refunds;
-
-      bool gas_error = use_gas(sub_gas_used);
-      if (gas_error) return;
-    };
+    Continuation cont = { FrameKind::CREATE };
+    cont.gas_limit   = gas_limit;
+    cont.old_refunds = transaction.gas_refunds;
+    cont.new_address = new_account.get_address();
 
     push_context(
       sm_checkpoint,
@@ -1132,10 +1183,9 @@ namespace eosio_evm
       gas_limit,
       false,
       0, // Value
-      std::move(std::vector<uint8_t>{}), // Data is empty
-      std::move(init_code),
-      std::move(success_cb),
-      std::move(error_cb)
+      {}, // Data is empty
+      std::make_shared<const Program>(std::move(init_code)),
+      cont
     );
   }
 
@@ -1161,11 +1211,10 @@ namespace eosio_evm
     const auto sizeIn     = ctx->s.pop();
     const auto off_out    = ctx->s.pop();
     const auto size_out   = ctx->s.pop();
-    if (ctx->s.stack_error) return throw_stack();
 
     // Fetch "to" account and code
     const Account& to_account = get_account(toAddress);
-    std::vector<uint8_t> new_code = to_account.get_code();
+    auto new_program = get_program(to_account);
 
     // Dynamically determine parameters
     const bool     is_static  = op == Opcode::STATICCALL || ctx->is_static;
@@ -1175,19 +1224,18 @@ namespace eosio_evm
                                   : to_account;
 
     // Fetch input if available (+ charge for gas in mem access prepare)
-    std::vector<uint8_t> input = {};
-    if (sizeIn > 0) {
-      bool error = access_mem(offIn, sizeIn);
-      if (error) return;
+    uint64_t in_offset, in_size;
+    bool in_error = access_mem(offIn, sizeIn, in_offset, in_size);
+    if (in_error) return;
 
-      input = {
-        ctx->mem.begin() + static_cast<uint64_t>(offIn),
-        ctx->mem.begin() + static_cast<uint64_t>(offIn) + static_cast<uint64_t>(sizeIn)
-      };
+    SharedBytes input;
+    if (in_size > 0) {
+      input = std::vector<uint8_t>(ctx->mem.begin() + in_offset, ctx->mem.begin() + in_offset + in_size);
     }
 
     // Prepare memory for output and pay gas for memory
-    bool error = access_mem(off_out, size_out);
+    uint64_t out_offset, out_size;
+    bool error = access_mem(off_out, size_out, out_offset, out_size);
     if (error) return;
 
     // callValueTransfer (9000) (PRE 63/64)
@@ -1221,14 +1269,13 @@ namespace eosio_evm
     }
 
     // Clear return data
-    ctx->last_return_data.clear();
+    ctx->last_return_data = {};
 
     // Depth and balance Validation
     bool max_call_depth = get_call_depth() > MAX_CALL_DEPTH;
     bool insufficient_balance = ctx->callee.get_balance() < value;
     if (max_call_depth || insufficient_balance) {
       ctx->s.push(0);
-      if (ctx->s.stack_error) return throw_stack();
       return;
     }
 
@@ -1246,64 +1293,21 @@ namespace eosio_evm
       bool transfer_error = transfer_internal(ctx->callee.get_address(), new_callee.get_address(), value);
       if (transfer_error) {
         ctx->s.push(0);
-        if (ctx->s.stack_error) return throw_stack();
         return;
       }
     }
 
     // Skip execution if code is empty and not a precompile
-    if (!is_precompile(toAddress) && new_code.empty()) {
+    if (!is_precompile(toAddress) && new_program->code.empty()) {
       ctx->s.push(1);
-      if (ctx->s.stack_error) return throw_stack();
       return;
     }
 
-    // Initial refunds
-    const auto old_refunds = transaction.gas_refunds;
-
-    // Push call context with callbacks
-    auto p_ctx = ctx;
-
-    auto success_cb = [&, p_ctx, size_out, off_out](const std::vector<uint8_t>& output, const uint256_t& sub_gas_used) {
-      p_ctx->last_return_data = output;
-
-      p_ctx->s.push(1);
-      if (p_ctx->s.stack_error) return throw_stack();
-
-      // Copy results to memory
-      auto bytes_to_copy = std::min(static_cast<unsigned int>(size_out), output.size());
-      if (bytes_to_copy > 0) {
-        std::memcpy(&p_ctx->mem[static_cast<uint64_t>(off_out)], output.data(), bytes_to_copy);
-      }
-
-      // Charge sub-execution gas
-      bool error = use_gas(sub_gas_used);
-      if (error) return;
-    };
-
-    auto error_cb = [&, p_ctx, size_out, off_out, old_refunds](const Exception& ex_, const std::vector<uint8_t>& output, const uint256_t& sub_gas_used) {
-      if (ex_.type == ET::revert) {
-        p_ctx->last_return_data = output;
-      }
-
-      p_ctx->s.push(0);
-      if (p_ctx->s.stack_error) return throw_stack();
-
-      // Only copy output to memory if REVERT
-      if (ex_.type == ET::revert) {
-        auto bytes_to_copy = std::min(static_cast<unsigned int>(size_out), output.size());
-        if (bytes_to_copy > 0) {
-          std::memcpy(&p_ctx->mem[static_cast<uint64_t>(off_out)], output.data(), bytes_to_copy);
-        }
-      }
-
-      // Reset refunds
-      transaction.gas_refunds = old_refunds;
-
-      // Charge sub-execution gas
-      bool error = use_gas(sub_gas_used);
-      if (error) return;
-    };
+    // Push call context, output goes to [off_out, off_out + size_out) of this context
+    Continuation cont = { FrameKind::CALL };
+    cont.out_offset  = out_offset;
+    cont.out_size    = out_size;
+    cont.old_refunds = transaction.gas_refunds;
 
     push_context(
       sm_checkpoint,
@@ -1313,9 +1317,8 @@ namespace eosio_evm
       is_static,
       value,
       std::move(input),
-      std::move(new_code),
-      std::move(success_cb),
-      std::move(error_cb)
+      std::move(new_program),
+      cont
     );
 
     // Executes precompile
@@ -1328,47 +1331,38 @@ namespace eosio_evm
   {
     const auto offset = ctx->s.pop();
     const auto size = ctx->s.pop();
-    if (ctx->s.stack_error) return throw_stack();
 
     // Prepare memory access
-    bool error = access_mem(offset, size);
+    uint64_t o, s;
+    bool error = access_mem(offset, size, o, s);
     if (error) return;
 
     // Fetch output
-    std::vector<uint8_t> output = {
-      ctx->mem.begin() + static_cast<uint64_t>(offset),
-      ctx->mem.begin() + static_cast<uint64_t>(offset) + static_cast<uint64_t>(size)
-    };
+    SharedBytes output = std::vector<uint8_t>(ctx->mem.begin() + o, ctx->mem.begin() + o + s);
 
-    // invoke caller's return handler
-    auto success_cb = ctx->success_cb;
-    auto gas_used = ctx->gas_used();
+    // Resume caller
+    const auto cont = ctx->cont;
+    const auto gas_used = ctx->gas_used();
 
     pop_context();
-    success_cb(output, gas_used);
+    resume(cont, nullptr, std::move(output), gas_used);
   }
 
   void Processor::revert()
   {
     const auto offset = ctx->s.pop();
     const auto size   = ctx->s.pop();
-    if (ctx->s.stack_error) return throw_stack();
 
     // Prepare Memory
-    bool error = access_mem(offset, size);
+    uint64_t o, s;
+    bool error = access_mem(offset, size, o, s);
     if (error) return;
 
-    // Fetch output
-    std::vector<uint8_t> output = {
-      ctx->mem.begin() + static_cast<uint64_t>(offset),
-      ctx->mem.begin() + static_cast<uint64_t>(offset) + static_cast<uint64_t>(size)
-    };
-
-    // Set return data
-    ctx->last_return_data = output;
+    // Fetch output, resume hands it to the caller as return data
+    SharedBytes output = std::vector<uint8_t>(ctx->mem.begin() + o, ctx->mem.begin() + o + s);
 
     // Error
-    throw_error(Exception(ET::revert, "One of the actions in this transaction was REVERTed."), output);
+    throw_error(Exception(ET::revert, "One of the actions in this transaction was REVERTed."), std::move(output));
   }
 
   void Processor::selfdestruct()
@@ -1380,7 +1374,6 @@ namespace eosio_evm
 
     // Pop Stack
     auto recipient_address = ctx->s.pop_addr();
-    if (ctx->s.stack_error) return throw_stack();
 
     // Find recipient
     auto recipient = get_account(recipient_address);
@@ -1421,7 +1414,7 @@ namespace eosio_evm
 
     // Add to list for later removal of account data and storage keys
     transaction.selfdestruct_list.push_back(contract_address);
-    transaction.add_modification({ SMT::SELF_DESTRUCT, 0, contract_address, 0, 0, 0 });
+    transaction.state_modifications.add(SMT::SELF_DESTRUCT);
 
     // Stop execution
     stop();
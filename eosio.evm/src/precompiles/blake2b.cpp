@@ -167,6 +167,6 @@ namespace eosio_evm
     std::memcpy(&result[0], std::begin(state.h), result.size());
 
     // Return
-    precompile_return(result);
+    precompile_return(std::move(result));
   }
 } // namespace eosio_evm
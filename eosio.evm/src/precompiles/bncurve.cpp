@@ -33,7 +33,7 @@ namespace eosio_evm
     if (error) return;
 
 		// Input
-		std::vector<uint8_t> input(ctx->input);
+		std::vector<uint8_t> input(ctx->input.begin(), ctx->input.end());
 		input.resize(128);
 
 		// Get x and y
@@ -81,7 +81,7 @@ namespace eosio_evm
 
 		// Return early if zero
 		if (point.is_zero()) {
-			return precompile_return(result);
+			return precompile_return(std::move(result));
 		}
 
 		// TO AFFINE
@@ -96,7 +96,7 @@ namespace eosio_evm
     std::copy(std::begin(res2), std::begin(res2) + 32, result.begin() + 32);
 
 		// Return
-		return precompile_return(result);
+		return precompile_return(std::move(result));
   }
 
   void Processor::precompile_bnmul()
@@ -106,7 +106,7 @@ namespace eosio_evm
     if (error) return;
 
 		// Input
-		std::vector<uint8_t> input(ctx->input);
+		std::vector<uint8_t> input(ctx->input.begin(), ctx->input.end());
 		input.resize(96);
 
 		// Get x, y and mul
@@ -145,7 +145,7 @@ namespace eosio_evm
 
 		// Return early if zero
 		if (point.is_zero()) {
-			return precompile_return(result);
+			return precompile_return(std::move(result));
 		}
 
 		// AFFINE
@@ -160,13 +160,13 @@ namespace eosio_evm
     std::copy(std::begin(res2), std::begin(res2) + 32, result.begin() + 32);
 
 		// Return
-		return precompile_return(result);
+		return precompile_return(std::move(result));
   }
 
 	void Processor::precompile_bnpairing()
   {
 		// Input
-		std::vector<uint8_t> input(ctx->input);
+		std::vector<uint8_t> input(ctx->input.begin(), ctx->input.end());
 
 		// Parameters
 		auto INPUT_SIZE = 192;
@@ -186,7 +186,7 @@ namespace eosio_evm
 		if (input.size() == 0) {
 			std::vector<uint8_t> result(32);
 			result[31] = 1;
-			return precompile_return(result);
+			return precompile_return(std::move(result));
 		}
 
 		// Initialize
@@ -278,7 +278,7 @@ namespace eosio_evm
 		result[31] = libff::alt_bn128_final_exponentiation(accumulator) == GT::one();
 
 		// Return
-		return precompile_return(result);
+		return precompile_return(std::move(result));
   }
 } // namespace eosio_evm
 
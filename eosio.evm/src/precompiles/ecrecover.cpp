@@ -11,18 +11,22 @@ namespace eosio_evm
     bool error = use_gas(GP_ECRECOVER);
     if (error) return;
 
+    // Input is zero padded to 128 bytes, shared input has no bytes past its end
+    std::array<uint8_t, 128> input = {};
+    std::copy_n(ctx->input.begin(), std::min<size_t>(ctx->input.size(), input.size()), input.begin());
+
     // Get hash
     std::array<uint8_t, 32> output = {};
-    std::copy(ctx->input.begin(), ctx->input.begin() + 32, std::begin(output));
+    std::copy(input.begin(), input.begin() + 32, std::begin(output));
     auto hash = eosio::fixed_bytes<32>(output);
 
     // Get v,r,s
     uint8_t v_bytes[32];
     uint8_t r_bytes[32];
     uint8_t s_bytes[32];
-    std::copy(ctx->input.begin() + 32, ctx->input.begin() + 64, std::begin(v_bytes));
-    std::copy(ctx->input.begin() + 64, ctx->input.begin() + 96, std::begin(r_bytes));
-    std::copy(ctx->input.begin() + 96, ctx->input.begin() + 128, std::begin(s_bytes));
+    std::copy(input.begin() + 32, input.begin() + 64, std::begin(v_bytes));
+    std::copy(input.begin() + 64, input.begin() + 96, std::begin(r_bytes));
+    std::copy(input.begin() + 96, input.begin() + 128, std::begin(s_bytes));
 
     uint256_t v = intx::be::load<uint256_t>(v_bytes);
     uint256_t r = intx::be::load<uint256_t>(r_bytes);
@@ -90,6 +94,6 @@ namespace eosio_evm
     std::copy(std::begin(hashed_key) + 12, std::end(hashed_key), std::begin(result) + 12);
 
     // Return
-    precompile_return(result);
+    precompile_return(std::move(result));
   }
 } // namespace eosio_evm
@@ -126,13 +126,13 @@ namespace eosio_evm
 
     // Mod less than equal 1
     if (m <= 1) {
-      return precompile_return(vec);
+      return precompile_return(std::move(vec));
     }
 
     // Execute
     bmi_to_bytes(boost::multiprecision::powm(b, e, m), vec);
 
     // Return the result.
-    precompile_return(vec);
+    precompile_return(std::move(vec));
   }
 } // namespace eosio_evm
@@ -12,8 +12,7 @@ namespace eosio_evm
     bool error = use_gas(gas_cost);
     if (error) return;
 
-    // Return the result.
-    const auto data = ctx->input;
-    precompile_return(data);
+    // Return the input itself, shared with the caller
+    precompile_return(ctx->input);
   }
 } // namespace eosio_evm
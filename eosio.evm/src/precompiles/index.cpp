@@ -5,13 +5,13 @@
 
 namespace eosio_evm
 {
-  void Processor::precompile_return(const std::vector<uint8_t>& output) {
-    // invoke caller's return handler
-    auto success_cb = ctx->success_cb;
-    auto gas_used = ctx->gas_used();
+  void Processor::precompile_return(SharedBytes output) {
+    // Resume caller
+    const auto cont = ctx->cont;
+    const auto gas_used = ctx->gas_used();
 
     pop_context();
-    success_cb(output, gas_used);
+    resume(cont, nullptr, std::move(output), gas_used);
   }
 
   void Processor::precompile_execute(uint256_t address)
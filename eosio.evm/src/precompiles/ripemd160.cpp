@@ -24,6 +24,6 @@ namespace eosio_evm
     std::copy(c_bytes.begin(), c_bytes.end(), std::begin(result) + 12);
 
     // Return the result.
-    precompile_return(result);
+    precompile_return(std::move(result));
   }
 } // namespace eosio_evm
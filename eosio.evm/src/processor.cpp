@@ -30,6 +30,13 @@ namespace eosio_evm
     for (const auto& addr : transaction.selfdestruct_list) {
       selfdestruct(addr);
     }
+
+    // Write back storage
+    commit_storage();
+
+    #if (PRINT_STATS == true)
+    eosio::print("\nSHA3 memo hits: ", sha3_memo.hits, " misses: ", sha3_memo.misses, "\n");
+    #endif
   }
 
   ExecResult Processor::initialize_create(const Account& caller) {
@@ -47,21 +54,6 @@ namespace eosio_evm
 
     // Push initial context
     ExecResult result;
-    auto success_cb = [&result](const std::vector<uint8_t>& output, const uint256_t& sub_gas_used) {
-      result.er = ExitReason::returned;
-      result.output = move(output);
-      result.gas_used = sub_gas_used;
-    };
-    auto error_cb = [&](const Exception& ex_, const std::vector<uint8_t>& output, const uint256_t& sub_gas_used) {
-      result.er = ExitReason::threw;
-      result.ex = ex_.type;
-      result.exmsg = ex_.what();
-      result.output = output;
-      result.gas_used = sub_gas_used;
-
-      // Reset refunds
-      transaction.gas_refunds = 0;
-    };
     push_context(
       transaction.state_modifications.size(),
       caller,
@@ -69,10 +61,9 @@ namespace eosio_evm
       transaction.gas_left(),
       false,
       transaction.value,
-      std::move(std::vector<uint8_t>{}), // Data is empty
-      std::move(transaction.data),  // Init data used as code here
-      std::move(success_cb),
-      std::move(error_cb)
+      {}, // Data is empty
+      std::make_shared<const Program>(std::move(transaction.data)),  // Init data used as code here
+      { FrameKind::TOP_LEVEL, &result }
     );
 
     // Run
@@ -115,21 +106,6 @@ namespace eosio_evm
 
     // Push initial context
     ExecResult result;
-    auto success_cb = [&result](const std::vector<uint8_t>& output, const uint256_t& sub_gas_used) {
-      result.er = ExitReason::returned;
-      result.output = move(output);
-      result.gas_used = sub_gas_used;
-    };
-    auto error_cb = [&](const Exception& ex_, const std::vector<uint8_t>& output, const uint256_t& sub_gas_used) {
-      result.er = ExitReason::threw;
-      result.ex = ex_.type;
-      result.exmsg = ex_.what();
-      result.output = move(output);
-      result.gas_used = sub_gas_used;
-
-      // Reset refunds
-      transaction.gas_refunds = 0;
-    };
     push_context(
       transaction.state_modifications.size(),
       caller,
@@ -137,10 +113,9 @@ namespace eosio_evm
       transaction.gas_left(),
       false,
       transaction.value,
-      std::move(transaction.data),
-      std::move(callee.get_code()),
-      std::move(success_cb),
-      std::move(error_cb)
+      SharedBytes(std::move(transaction.data)),
+      get_program(callee),
+      { FrameKind::TOP_LEVEL, &result }
     );
 
     // Executes precompile
@@ -160,49 +135,49 @@ namespace eosio_evm
 
   void Processor::run()
   {
-    // Execute code
-    while(!ctxs.empty())
+    // Execute code (instruction stream always ends with STOP)
+    while(depth != 0)
     {
       ctx->step();
-
-      // Execute
-      if (ctx->get_pc() < ctx->prog.code.size())
-      {
-        dispatch();
-      }
-      // Stop
-      else
-      {
-        stop();
-      }
+      dispatch();
     }
   }
 
-  uint16_t Processor::get_call_depth() const { return static_cast<uint16_t>(ctxs.size()); }
+  uint16_t Processor::get_call_depth() const { return static_cast<uint16_t>(depth); }
   const uint8_t Processor::get_op() const {
-    return ctx->prog.code[ctx->get_pc()];
+    return ctx->get_instr().opcode;
   }
 
   void Processor::revert_state(const size_t& revert_to) {
-    for (unsigned i = transaction.state_modifications.size() ; i-- > revert_to ; ) {
-      const auto [type, index, key, oldvalue, amount, newvalue] = transaction.state_modifications[i];
+    auto& journal = transaction.state_modifications;
+
+    // Undo operations may add entries, they are dropped by truncate
+    for (auto i = journal.size(); i-- > revert_to; ) {
+      const auto entry = journal.entries[i];
 
-      switch (type) {
-        case SMT::STORE_KV:
-          storekv(index, key, oldvalue);
+      switch (entry.type) {
+        case SMT::STORE_KV: {
+          const auto& change = journal.storage_changes[entry.pos];
+          get_slots(change.index)[change.key].value = change.oldvalue;
           break;
+        }
         case SMT::CREATE_ACCOUNT:
-          remove_account(key);
+          remove_account(journal.addresses[entry.pos]);
           break;
         case SMT::SET_CODE:
-          remove_code(key);
+          remove_code(journal.addresses[entry.pos]);
           break;
         case SMT::INCREMENT_NONCE:
-          decrement_nonce(key);
+          decrement_nonce(journal.addresses[entry.pos]);
           break;
-        case SMT::TRANSFER:
-          transfer_internal(oldvalue, key, amount);
+        case SMT::KILL_STORAGE:
+          restore_storage(journal.addresses[entry.pos]);
           break;
+        case SMT::TRANSFER: {
+          const auto transfer = journal.transfers[entry.pos];
+          transfer_internal(transfer.to, transfer.from, transfer.amount);
+          break;
+        }
         case SMT::LOG:
           transaction.logs.pop();
           break;
@@ -214,11 +189,7 @@ namespace eosio_evm
       }
     }
 
-    // Slice vector
-    transaction.state_modifications = std::vector<StateModification>(
-      transaction.state_modifications.begin(),
-      transaction.state_modifications.begin() + revert_to
-    );
+    journal.truncate(revert_to);
   }
 
   void Processor::push_context(
@@ -228,12 +199,18 @@ namespace eosio_evm
     uint256_t gas_left,
     const bool is_static,
     const uint256_t call_value,
-    std::vector<uint8_t>&& input,
-    Program&& prog,
-    SuccessHandler&& success_cb,
-    ErrorHandler&& error_cb
+    SharedBytes input,
+    std::shared_ptr<const Program> prog,
+    const Continuation& cont
   ) {
-    auto c = std::make_unique<Context>(
+    if (depth == frames.size()) {
+      frames.emplace_back(std::make_unique<Frame>());
+    }
+
+    auto& frame = *frames[depth];
+    frame.ctx.emplace(
+      frame.s,
+      frame.mem,
       sm_checkpoint,
       caller,
       callee,
@@ -242,29 +219,120 @@ namespace eosio_evm
       call_value,
       std::move(input),
       std::move(prog),
-      std::move(success_cb),
-      std::move(error_cb)
+      cont
     );
 
-    ctxs.emplace_back(move(c));
-    ctx = ctxs.back().get();
+    depth++;
+    ctx = &*frame.ctx;
+  }
+
+  // Code is analysed once per account and action, contexts and batched transactions share the result
+  std::shared_ptr<const Program> Processor::get_program(const Account& account) {
+    // Empty accounts may not exist in the table, they all share one empty program
+    if (account.get_code_size() == 0) {
+      static const auto empty_program = std::make_shared<const Program>(std::vector<uint8_t>{});
+      return empty_program;
+    }
+
+    auto& program = contract->_programs[account.primary_key()];
+    if (!program) {
+      program = std::make_shared<const Program>(contract->get_code(account));
+    }
+    return program;
   }
 
   void Processor::pop_context() {
-    ctxs.pop_back();
-    if (!ctxs.empty()) {
-      ctx = ctxs.back().get();
+    // The frame keeps its context until reused, so callers may still read its memory
+    depth--;
+    if (depth != 0) {
+      ctx = &*frames[depth - 1]->ctx;
     } else {
       ctx = nullptr;
     }
   }
 
+  // Hands the result of a popped context to its parent, ex is nullptr on success
+  void Processor::resume(const Continuation& cont, const Exception* ex, SharedBytes output, const uint256_t& sub_gas_used)
+  {
+    // Reset refunds
+    if (ex) {
+      transaction.gas_refunds = cont.old_refunds;
+    }
+
+    switch (cont.kind) {
+      case FrameKind::TOP_LEVEL: {
+        auto& result = *cont.result;
+        result.er = ex ? ExitReason::threw : ExitReason::returned;
+        if (ex) {
+          result.ex = ex->type;
+          result.exmsg = ex->what();
+        }
+        result.output = output.release();
+        result.gas_used = sub_gas_used;
+        break;
+      }
+      case FrameKind::CALL: {
+        // Output is only kept on success or REVERT
+        if (!ex || ex->type == ET::revert) {
+          ctx->last_return_data = output;
+
+          // Copy results to memory
+          auto bytes_to_copy = std::min(cont.out_size, static_cast<uint64_t>(output.size()));
+          if (bytes_to_copy > 0) {
+            std::memcpy(&ctx->mem[cont.out_offset], output.data(), bytes_to_copy);
+          }
+        }
+
+        ctx->s.push(ex ? 0 : 1);
+
+        // Charge sub-execution gas
+        use_gas(sub_gas_used);
+        break;
+      }
+      case FrameKind::CREATE: {
+        if (ex) {
+          // Set return data if revert
+          if (ex->type == ET::revert) {
+            ctx->last_return_data = output;
+          }
+
+          ctx->s.push(0);
+          use_gas(sub_gas_used);
+          break;
+        }
+
+        auto create_data_gas = output.size() * GP_CREATE_DATA;
+        auto total_sub_gas = sub_gas_used + create_data_gas;
+
+        // Error
+        if (total_sub_gas > cont.gas_limit) {
+          bool gas_error = use_gas(cont.gas_limit);
+          if (gas_error) return;
+
+          ctx->s.push(0);
+          break;
+        }
+
+        // Charge gas
+        bool gas_error = use_gas(total_sub_gas);
+        if (gas_error) return;
+
+        // Set code
+        set_code(cont.new_address, output.release());
+
+        // Push created address on stack
+        ctx->s.push(cont.new_address);
+        break;
+      }
+    }
+  }
+
   void Processor::refund_gas(uint256_t amount) {
     ctx->gas_left += amount;
   }
 
   // Returns true if error
-  bool Processor::throw_error(const Exception& exception, const std::vector<uint8_t>& output)
+  bool Processor::throw_error(const Exception& exception, SharedBytes output)
   {
     // Add to error log
     transaction.errors.push_back(exception.what());
@@ -277,18 +345,15 @@ namespace eosio_evm
     // Revert all state changes
     revert_state(ctx->sm_checkpoint);
 
-    // Pop context and Call error callback
-    auto error_cb = ctx->error_cb;
-    auto gas_used = ctx->gas_used();
+    // Pop context and resume parent
+    const auto cont = ctx->cont;
+    const auto gas_used = ctx->gas_used();
     pop_context();
-    error_cb(exception, output, gas_used);
+    resume(cont, &exception, std::move(output), gas_used);
 
     // Always true for error
     return true;
   }
-  void Processor::throw_stack() {
-    throw_error(Exception(ET::OOB, *ctx->s.stack_error), {});
-  }
 
   // Returns true if error
   bool Processor::use_gas(uint256_t amount) {
@@ -301,6 +366,20 @@ namespace eosio_evm
     return false;
   }
 
+  // Returns true if error
+  bool Processor::begin_block(const BasicBlock& block) {
+    const auto stack_size = static_cast<int64_t>(ctx->s.size());
+    if (stack_size < block.stack_req) {
+      return throw_error(Exception(ET::OOB, "Stack out of range"), {});
+    }
+    if (stack_size + block.stack_max_growth > static_cast<int64_t>(MAX_STACK_SIZE)) {
+      return throw_error(Exception(ET::OOB, "Stack memory exceeded"), {});
+    }
+    ctx->s.reserve(stack_size + block.stack_max_growth);
+
+    return use_gas(block.gas);
+  }
+
   // Complex calculation from EIP 2200
   // - Original value is the first value at start of TX
   // - Current value is what is currently stored in EOSIO
@@ -362,18 +441,17 @@ namespace eosio_evm
   // Return true if error
   bool Processor::jump_to(const uint256_t& newPc)
   {
-    if (newPc > ctx->prog.code.size() || newPc > std::numeric_limits<uint64_t>::max()) {
+    if (newPc > ctx->prog->code.size()) {
       return throw_error(Exception(ET::illegalInstruction, "Invalid Jump Destination"), {});
     }
 
-    auto bounded_pc = static_cast<uint64_t>(newPc);
-
-    if (ctx->prog.jump_dests.find(bounded_pc) == ctx->prog.jump_dests.end()) {
+    const auto dest = ctx->prog->find_jumpdest(static_cast<uint64_t>(newPc));
+    if (dest == NO_INSTRUCTION) {
       return throw_error(Exception(ET::illegalInstruction, "Invalid Jump Destination"), {});
     }
 
-    // Set PC
-    ctx->set_pc(bounded_pc);
+    // Set instruction pointer
+    ctx->set_ip(dest);
     return false;
   }
 } // namespace eosio_evm
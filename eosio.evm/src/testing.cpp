@@ -26,13 +26,32 @@ namespace eosio_evm {
 
     auto ubalance = intx::from_string<uint256_t>(balance);
     eosio::check(ubalance >= 0, "Balance cannot be negative");
+    const auto code_hash = add_code(get_self(), code);
     _accounts.emplace(get_self(), [&](auto& a) {
-      a.index   = _accounts.available_primary_key();
+      a.index   = next_account_index();
       a.address = address;
       a.account = account;
       a.balance = ubalance;
       a.nonce   = nonce;
-      a.code    = code;
+      a.set_code_ref(code_hash, code.size());
+    });
+  }
+
+  // Rewrites an account as a row written before the code table, with its code inline
+  void evm::devinlinecode(const eosio::checksum160& address, const std::vector<uint8_t> code) {
+    require_auth(get_self());
+
+    auto accounts_byaddress = _accounts.get_index<eosio::name("byaddress")>();
+    auto existing_address   = accounts_byaddress.find(pad160(address));
+    eosio::check(existing_address != accounts_byaddress.end(), "address does not exist");
+    eosio::check(existing_address->storage_generation.value_or(0) == 0, "storage of account was wiped");
+
+    release_code(*existing_address);
+    accounts_byaddress.modify(existing_address, eosio::same_payer, [&](auto& a) {
+      a.code = code;
+      a.code_hash.reset();
+      a.code_size.reset();
+      a.storage_generation.reset();
     });
   }
 
@@ -49,7 +68,7 @@ namespace eosio_evm {
     auto checksum_value = intx::from_string<uint256_t>(value);
 
     // Store KV
-    account_state_table accounts_states(get_self(), existing_address->index);
+    account_state_table accounts_states(get_self(), existing_address->get_storage_scope());
     auto accounts_states_bykey = accounts_states.get_index<eosio::name("bykey")>();
     auto account_state         = accounts_states_bykey.find(checksum_key);
     accounts_states.emplace(get_self(), [&](auto& a) {
@@ -69,13 +88,46 @@ namespace eosio_evm {
     raw(get_self(), tx, std::nullopt);
   }
 
+  // Erases all accounts, code and storage, including scopes left by wiped storage
+  void evm::clearall() {
+    require_auth(get_self());
+
+    account_table db(get_self(), get_self().value);
+    auto itr = db.end();
+    while(db.begin() != itr){
+      clear_scope((--itr)->get_storage_scope());
+      itr = db.erase(itr);
+    }
+
+    account_code_table db3(get_self(), get_self().value);
+    auto itr3 = db3.end();
+    while(db3.begin() != itr3){
+      itr3 = db3.erase(--itr3);
+    }
+
+    stale_scope_table stale(get_self(), get_self().value);
+    auto itr4 = stale.begin();
+    while(itr4 != stale.end()){
+      clear_scope(itr4->scope);
+      itr4 = stale.erase(itr4);
+    }
+  }
+
+  void evm::clear_scope(const uint64_t& scope) {
+    account_state_table db2(get_self(), scope);
+    auto itr = db2.end();
+    while(db2.begin() != itr){
+      itr = db2.erase(--itr);
+    }
+  }
+
   void evm::printaccount(const eosio::checksum160& address) {
     auto accounts_byaddress = _accounts.get_index<eosio::name("byaddress")>();
     auto existing_address   = accounts_byaddress.find(pad160(address));
 
     eosio::print("{");
     if (existing_address != accounts_byaddress.end()) {
-      auto code = bin2hex(existing_address->get_code());
+      auto code = bin2hex(get_code(*existing_address));
       code = code.length() % 2 == 0 ? "0x" + code : "0x0" + code;
 
       auto nonce = intx::hex(intx::from_string<uint256_t>(std::to_string(existing_address->get_nonce())));
@@ -100,7 +152,7 @@ namespace eosio_evm {
 
     if (existing_address != accounts_byaddress.end()) {
       // Get scoped state table for account
-      account_state_table accounts_states(get_self(), existing_address->index);
+      account_state_table accounts_states(get_self(), existing_address->get_storage_scope());
       auto itr = accounts_states.begin();
       while(itr != accounts_states.end()){
         std::string key = intx::hex(checksum256ToValue(itr->key));
@@ -34,6 +34,7 @@ const bool erc20_enabled             = false;
 const bool erc721_enabled            = false;
 const bool transaction_tests_enabled = false;
 const bool state_tests_enabled       = true;
+const bool unit_tests_enabled        = true;
 const bool debugging_enabled         = false;
 
 class eosio_evm_tester : public tester {
@@ -69,6 +70,37 @@ public:
       abi_ser.set_abi(token_abi, abi_serializer_max_time);
    }
 
+   fc::variant get_account_row( uint64_t index )
+   {
+      vector<char> data = get_row_by_account( N(eosio.evm), N(eosio.evm), N(account), name(index) );
+      return data.empty() ? fc::variant() : abi_ser.binary_to_variant( "Account", data, abi_serializer_max_time );
+   }
+
+   fc::variant get_code_row( uint64_t index )
+   {
+      vector<char> data = get_row_by_account( N(eosio.evm), N(eosio.evm), N(accountcode), name(index) );
+      return data.empty() ? fc::variant() : abi_ser.binary_to_variant( "AccountCode", data, abi_serializer_max_time );
+   }
+
+   fc::variant get_state_row( uint64_t scope, uint64_t index )
+   {
+      vector<char> data = get_row_by_account( N(eosio.evm), name(scope), N(accountstate), name(index) );
+      return data.empty() ? fc::variant() : abi_ser.binary_to_variant( "AccountState", data, abi_serializer_max_time );
+   }
+
+   fc::variant get_stale_scope( uint64_t scope )
+   {
+      vector<char> data = get_row_by_account( N(eosio.evm), N(eosio.evm), N(stalescope), name(scope) );
+      return data.empty() ? fc::variant() : abi_ser.binary_to_variant( "StaleScope", data, abi_serializer_max_time );
+   }
+
+   // Accounts never wiped have no generation stored
+   uint64_t get_storage_generation( uint64_t index )
+   {
+      const auto row = get_account_row(index).get_object();
+      return row.contains("storage_generation") ? row["storage_generation"].as_uint64() : 0;
+   }
+
    fc::variant get_account( account_name acc )
    {
       vector<char> data = get_row_by_account( N(eosio.evm), N(eosio.evm), N(account), acc );
@@ -90,6 +122,89 @@ public:
       );
    }
 
+   transaction_trace_ptr devnewacct( const std::string& address, const std::string& balance, const std::string& code = "", uint64_t nonce = 0 )
+   {
+      return base_tester::push_action( N(eosio.evm), N(devnewacct), N(eosio.evm), mvo()
+           ( "address", address )
+           ( "balance", balance )
+           ( "code", eosio_system::HexToBytes(code) )
+           ( "nonce", nonce )
+           ( "account", "" )
+      );
+   }
+
+   transaction_trace_ptr devinlinecode( const std::string& address, const std::string& code )
+   {
+      return base_tester::push_action( N(eosio.evm), N(devinlinecode), N(eosio.evm), mvo()
+           ( "address", address )
+           ( "code", eosio_system::HexToBytes(code) )
+      );
+   }
+
+   transaction_trace_ptr migratecode( uint64_t start_index, uint64_t limit )
+   {
+      return base_tester::push_action( N(eosio.evm), N(migratecode), N(eosio.evm), mvo()
+           ( "start_index", start_index )
+           ( "limit", limit )
+      );
+   }
+
+   transaction_trace_ptr rawbatch( const std::vector<std::string>& txs )
+   {
+      return base_tester::push_action( N(eosio.evm), N(rawbatch), N(eosio.evm), mvo()
+           ( "ram_payer", N(eosio.evm) )
+           ( "txs", txs )
+      );
+   }
+
+   transaction_trace_ptr cleanstorage( uint64_t limit )
+   {
+      return base_tester::push_action( N(eosio.evm), N(cleanstorage), N(eosio.evm), mvo()
+           ( "limit", limit )
+      );
+   }
+
+   transaction_trace_ptr devnewstore( const std::string& address, const std::string& key, const std::string& value )
+   {
+      return base_tester::push_action( N(eosio.evm), N(devnewstore), N(eosio.evm), mvo()
+           ( "address", address )
+           ( "key", key )
+           ( "value", value )
+      );
+   }
+
+   // Executes a signed transaction in a fixed block environment
+   transaction_trace_ptr teststatetx( const std::string& tx )
+   {
+      return base_tester::push_action( N(eosio.evm), N(teststatetx), N(eosio.evm), mvo()
+           ( "tx", tx )
+           ( "env", mvo()
+              ("currentCoinbase", "0x2adc25665018aa1fe0e6bc666dac8fc2697ff9ba")
+              ("currentDifficulty", "0x020000")
+              ("currentGasLimit", "0x7fffffffffffffff")
+              ("currentNumber", "0x01")
+              ("currentTimestamp", "0x03e8")
+              ("previousHash", "0x00")
+           )
+      );
+   }
+
+   fc::variant_object printstate( const std::string& address )
+   {
+      auto res = base_tester::push_action( N(eosio.evm), N(printstate), N(eosio.evm), mvo()
+           ( "address", address )
+      );
+      return fc::json::from_string(res->action_traces[0].console).get_object();
+   }
+
+   fc::variant_object printaccount( const std::string& address )
+   {
+      auto res = base_tester::push_action( N(eosio.evm), N(printaccount), N(eosio.evm), mvo()
+           ( "address", address )
+      );
+      return fc::json::from_string(res->action_traces[0].console).get_object();
+   }
+
    void create_currency( name contract, name manager, asset maxsupply ) {
       auto act =  mutable_variant_object()
          ("issuer",       manager )
@@ -275,6 +390,524 @@ BOOST_AUTO_TEST_SUITE(eosio_evm_base, * boost::unit_test::enable_if<base_enabled
    } FC_LOG_AND_RETHROW()
 BOOST_AUTO_TEST_SUITE_END()
 
+// Unit transactions are signed by the private key
+// 0x45a915e4d060149eb4365960e6a7a45f334393093061116b197e3240065ff2d8
+const std::string test_sender = "a94f5374fce5edbc8e2a8697c15331677e6ebf0b";
+const std::string test_balance = "0x0de0b6b3a7640000";
+
+BOOST_AUTO_TEST_SUITE(eosio_evm_unit, * boost::unit_test::enable_if<unit_tests_enabled>())
+   // Each level stores its depth in slot 0 and calls itself, the call at depth 1024 fails.
+   // Frames must only hold the stack they use for 1025 of them to fit in wasm memory.
+   BOOST_FIXTURE_TEST_CASE( deep_recursion, eosio_evm_tester ) try {
+      const std::string recursive = "c0de000000000000000000000000000000000001";
+      devnewacct( test_sender, test_balance );
+      devnewacct( recursive, "0x00", "6000356001018060005560005260006000602060006000305af100" );
+      produce_blocks(1);
+
+      teststatetx( "f8638080860fffffffffff94c0de00000000000000000000000000000000000180801ca043bef3300eeae2610877e9a6f922f446fe2386a59d682ab7fbb2d2206ed7320da075bf7f0ec66e71257ef86671125df44e940dda023bbaa10a70893c376dbb84db" );
+      produce_blocks(1);
+
+      auto state = printstate( recursive );
+      BOOST_REQUIRE_EQUAL( state["0x00"].as_string(), "0x0401" );
+   } FC_LOG_AND_RETHROW()
+
+   // Accounts written before the code table hold their code inline until migrated
+   BOOST_FIXTURE_TEST_CASE( migrate_inline_code, eosio_evm_tester ) try {
+      const std::string first  = "c0de000000000000000000000000000000000011";
+      const std::string second = "c0de000000000000000000000000000000000012";
+      const std::string empty  = "c0de000000000000000000000000000000000013";
+      const std::string code   = "600160005500";
+      devnewacct( first, "0x00", code );
+      devnewacct( second, "0x00", code );
+      devnewacct( empty, "0x00" );
+      devnewacct( test_sender, test_balance );
+      devinlinecode( first, code );
+      devinlinecode( second, code );
+      devinlinecode( empty, "" );
+      produce_blocks(1);
+      BOOST_REQUIRE( get_code_row(0).is_null() );
+
+      // First page stops at the third account
+      auto res = migratecode( 0, 2 );
+      BOOST_REQUIRE_EQUAL( res->action_traces[0].console, "2" );
+      produce_blocks(1);
+
+      // Identical inline code ends up in one shared row
+      auto code_row = get_code_row(0);
+      BOOST_REQUIRE_EQUAL( code_row["code"].as_string(), code );
+      BOOST_REQUIRE_EQUAL( code_row["refcount"].as_uint64(), 2 );
+      BOOST_REQUIRE( get_code_row(1).is_null() );
+      for (uint64_t i = 0; i < 2; i++) {
+         auto row = get_account_row(i);
+         BOOST_REQUIRE_EQUAL( row["code"].get_array().size(), 0 );
+         BOOST_REQUIRE_EQUAL( row["code_size"].as_uint64(), 6 );
+      }
+
+      // Last page, the empty account gets the empty code hash
+      res = migratecode( 2, 10 );
+      BOOST_REQUIRE_EQUAL( res->action_traces[0].console, "" );
+      BOOST_REQUIRE_EQUAL( get_account_row(2)["code_size"].as_uint64(), 0 );
+      produce_blocks(1);
+
+      // Migrated code still runs
+      BOOST_REQUIRE_EQUAL( printaccount( second )["code"].as_string(), "0x" + code );
+      teststatetx( "f8608080830186a094c0de00000000000000000000000000000000001280801ba077f30d93129a0985e78fbfbe6f0bb78b10c4988279291d1f05d9451da5eff312a041b90bd5d6e84cea1d2bd27a5f4e7e59ad9220a0e90e4c86ea058ea0b62df664" );
+      BOOST_REQUIRE_EQUAL( printstate( second )["0x00"].as_string(), "0x01" );
+   } FC_LOG_AND_RETHROW()
+
+   // Contracts with identical code share one code row, released by SELFDESTRUCT and by reverted creates
+   BOOST_FIXTURE_TEST_CASE( code_refcount, eosio_evm_tester ) try {
+      // Both created contracts run CALLER SELFDESTRUCT
+      const std::string first  = "6295ee1b4f6dd65047762f924ecd367c17eabf8f";
+      const std::string second = "ec0e71ad0a90ffe1909d27dac207f7680abba42d";
+      devnewacct( test_sender, test_balance );
+      teststatetx( "f857808083030d4080808b6133ff6000526002601ef31ca0ff4618ca63b5f28c36a55dd21a9aee3293fbb2ee4b8e3c90c64671c93f584ac3a05c16e231d0c4acb5403e918c79313010fdb3ca39f1194463481843db886af263" );
+      teststatetx( "f857018083030d4080808b6133ff6000526002601ef31ba0e9d4329c4b69a67bd809f71dc1e6ce9c560ffc4fd8a0999ddd77d282543a5380a05e4ce78cdf03dbf5407286f76c79f0ac7a72235418e6085b3c52e6cda74d8e3d" );
+      produce_blocks(1);
+      BOOST_REQUIRE_EQUAL( printaccount( first )["code"].as_string(), "0x33ff" );
+      BOOST_REQUIRE_EQUAL( printaccount( second )["code"].as_string(), "0x33ff" );
+      BOOST_REQUIRE_EQUAL( get_code_row(0)["refcount"].as_uint64(), 2 );
+      BOOST_REQUIRE( get_code_row(1).is_null() );
+
+      // SELFDESTRUCT drops a reference
+      teststatetx( "f8600280830186a0946295ee1b4f6dd65047762f924ecd367c17eabf8f80801ba0173fc934d398ad654a6e9cc15fe86e902282a48b8320c92a80b4c4624e09f13da00e1c4018a8218f299c9df9627214d32f9b925daac0a3975010a3eeee48157984" );
+      produce_blocks(1);
+      BOOST_REQUIRE_EQUAL( printaccount( first )["code"].as_string(), "0x" );
+      BOOST_REQUIRE_EQUAL( get_code_row(0)["refcount"].as_uint64(), 1 );
+
+      // A create that CREATEs the same code and then reverts leaves the count unchanged
+      auto res = teststatetx( "f868038083030d4080809c6a6133ff6000526002601ef3600052600b60156000f05060006000fd1ba0545bd13ecef7ac20c8052a411fec1c6f2efc6b91d1f41ce157c367d31c168191a05c930579fe6a354712f65b6ceb0a620b6471f91ead28b61d7b37d5fba9ee1ed7" );
+      BOOST_REQUIRE( res->action_traces[0].console.find("\"status\": \"0\"") != std::string::npos );
+      produce_blocks(1);
+      BOOST_REQUIRE_EQUAL( get_code_row(0)["refcount"].as_uint64(), 1 );
+
+      // The last reference erases the row
+      teststatetx( "f8600480830186a094ec0e71ad0a90ffe1909d27dac207f7680abba42d80801ba0b4bbb84bd13e3f39c47c5e1106e6b44ef46e1d4129aeade841cb77a83161fae0a0423a5e9e5ccbf038501947ed8d07c949b301f93491b13132e848d96d84fea294" );
+      produce_blocks(1);
+      BOOST_REQUIRE( get_code_row(0).is_null() );
+   } FC_LOG_AND_RETHROW()
+
+   // Sets 40 slots away from their original value and back, EIP 2200 prices
+   // the second SSTORE of each slot from the original value kept for the transaction
+   BOOST_FIXTURE_TEST_CASE( sstore_original_values, eosio_evm_tester ) try {
+      const std::string contract = "c0de000000000000000000000000000000000020";
+      devnewacct( test_sender, test_balance );
+      devnewacct( contract, "0x00", "60005b60028155600181556001018060281160025700" );
+      for (int i = 0; i < 40; i++) {
+         char key[8];
+         snprintf(key, sizeof(key), "0x%02x", i);
+         devnewstore( contract, key, "0x01" );
+      }
+      produce_blocks(1);
+
+      // 21000 + 3 + 40 * (41 + 5000 + 800)
+      auto res = teststatetx( "f8608080830f424094c0de00000000000000000000000000000000002080801ba0336506cab5c8630979535f120ce9fa2e1dd18a3d12180524e5e8157ca4b4c01fa02950d695eca39e691e98ffa483454569d94fa7b33067fc8160f3b20db39126a8" );
+      BOOST_REQUIRE( res->action_traces[0].console.find("\"gasUsed\": \"3e2b3\"") != std::string::npos );
+      produce_blocks(1);
+
+      auto state = printstate( contract );
+      BOOST_REQUIRE_EQUAL( state.size(), 40 );
+      BOOST_REQUIRE_EQUAL( state["0x27"].as_string(), "0x01" );
+   } FC_LOG_AND_RETHROW()
+
+   // Storage scopes are the account index, moved to (generation << 32) | index once wiped
+   BOOST_FIXTURE_TEST_CASE( clearall_stale_scopes, eosio_evm_tester ) try {
+      const std::string contract = "c0de000000000000000000000000000000000030";
+      const uint64_t old_scope = 1;
+      const uint64_t new_scope = (uint64_t(1) << 32) | 1;
+      devnewacct( test_sender, test_balance );
+      devnewacct( contract, "0x00", "33ff" );
+      devnewstore( contract, "0x01", "0x11" );
+      devnewstore( contract, "0x02", "0x12" );
+      produce_blocks(1);
+
+      // SELFDESTRUCT leaves its rows in a stale scope
+      teststatetx( "f8608080830186a094c0de00000000000000000000000000000000003080801ca07361a6dc037c9b8738ab2f163033ce646f06e863994c99f7d18b176c202d2a07a076461bc028c47b492f2a492d976f686ff341bd051e8dfb4c8c898fa6535b7be0" );
+      produce_blocks(1);
+      BOOST_REQUIRE_EQUAL( get_account_row(1)["storage_generation"].as_uint64(), 1 );
+      BOOST_REQUIRE( !get_stale_scope(old_scope).is_null() );
+      BOOST_REQUIRE_EQUAL( printstate( contract ).size(), 0 );
+
+      devnewstore( contract, "0x03", "0x13" );
+      produce_blocks(1);
+      BOOST_REQUIRE( !get_state_row(old_scope, 0).is_null() );
+      BOOST_REQUIRE( !get_state_row(new_scope, 0).is_null() );
+
+      // Both generations and the stale scope are gone
+      base_tester::push_action( N(eosio.evm), N(clearall), N(eosio.evm), mvo() );
+      produce_blocks(1);
+      BOOST_REQUIRE( get_stale_scope(old_scope).is_null() );
+      BOOST_REQUIRE( get_state_row(old_scope, 0).is_null() );
+      BOOST_REQUIRE( get_state_row(old_scope, 1).is_null() );
+      BOOST_REQUIRE( get_state_row(new_scope, 0).is_null() );
+   } FC_LOG_AND_RETHROW()
+
+   // CREATE2 onto an existing empty account moves it to a new storage generation
+   BOOST_FIXTURE_TEST_CASE( storage_generations, eosio_evm_tester ) try {
+      // Factory runs CREATE2 with salt 0 on calldata[32:], then reverts if calldata[0:32] is non-zero
+      const std::string factory  = "c0de000000000000000000000000000000000040";
+      const std::string target   = "64cac96dea646e26c740e45685274d47a333afb9"; // init 602260015500
+      const std::string empty    = "1c72d62a4e830d67a77183245cf40f75cc21d945"; // init 603360015500
+      const std::string destruct = "c0de000000000000000000000000000000000041"; // SSTORE then SELFDESTRUCT
+      const uint64_t old_scope = 2;
+      const uint64_t new_scope = (uint64_t(1) << 32) | 2;
+      devnewacct( test_sender, test_balance );
+      devnewacct( factory, "0x00", "366020900380602060003760009060006000f550600035601b57005b600080fd" );
+      devnewacct( target, "0x00" );
+      devnewacct( empty, "0x00" );
+      devnewacct( destruct, "0x00", "600160015533ff" );
+      devnewstore( target, "0x01", "0x11" );
+      devnewstore( target, "0x02", "0x12" );
+      devnewstore( target, "0x03", "0x13" );
+      produce_blocks(1);
+
+      // Reverted CREATE2 restores the generation and records no stale scope
+      teststatetx( "f8868080830f424094c0de00000000000000000000000000000000004080a600000000000000000000000000000000000000000000000000000000000000016022600155001ca0e022ef114ebfde0952ddcf55297f405b35b80dcf1cf31a7b30e90da07a1a3c8aa001800ed35ecc35d8593c57315707ee6cf6a61bd1ab656c4dc5a8de1c5e97a807" );
+      produce_blocks(1);
+      BOOST_REQUIRE_EQUAL( get_storage_generation(2), 0 );
+      BOOST_REQUIRE( get_stale_scope(old_scope).is_null() );
+      BOOST_REQUIRE_EQUAL( printstate( target ).size(), 3 );
+
+      // Committed CREATE2 writes to the new generation and leaves the old rows stale
+      teststatetx( "f8860180830f424094c0de00000000000000000000000000000000004080a600000000000000000000000000000000000000000000000000000000000000006022600155001ba0c91a1d1efea6283332b15773e6e14f00b9bd1142968c5008ad7ee91c49019576a02368c1cee9de127f59aebe30cca9e1a680822e2da0fc8e3aae23ffcb993ce0d9" );
+      produce_blocks(1);
+      BOOST_REQUIRE_EQUAL( get_storage_generation(2), 1 );
+      BOOST_REQUIRE( !get_stale_scope(old_scope).is_null() );
+      auto state = printstate( target );
+      BOOST_REQUIRE_EQUAL( state.size(), 1 );
+      BOOST_REQUIRE_EQUAL( state["0x01"].as_string(), "0x22" );
+      BOOST_REQUIRE( !get_state_row(new_scope, 0).is_null() );
+
+      // First page stops inside the stale scope, second page finishes it
+      auto res = cleanstorage( 2 );
+      BOOST_REQUIRE_EQUAL( res->action_traces[0].console, std::to_string(old_scope) );
+      produce_blocks(1);
+      BOOST_REQUIRE( !get_stale_scope(old_scope).is_null() );
+      BOOST_REQUIRE( !get_state_row(old_scope, 2).is_null() );
+      res = cleanstorage( 2 );
+      BOOST_REQUIRE_EQUAL( res->action_traces[0].console, "" );
+      produce_blocks(1);
+      BOOST_REQUIRE( get_stale_scope(old_scope).is_null() );
+      BOOST_REQUIRE( get_state_row(old_scope, 2).is_null() );
+      BOOST_REQUIRE( !get_state_row(new_scope, 0).is_null() );
+
+      // Account without storage keeps its generation
+      teststatetx( "f8860280830f424094c0de00000000000000000000000000000000004080a600000000000000000000000000000000000000000000000000000000000000006033600155001ba0ae47b19c81aafe4d7ecec6a247bb0371b441638dbdd71e51f6a0a141b6ee230ca0501b581c08208956d0c23394fa03826c776bf7cfac99aff7351804fa6f497b1d" );
+      produce_blocks(1);
+      BOOST_REQUIRE_EQUAL( get_storage_generation(3), 0 );
+      BOOST_REQUIRE( get_stale_scope(3).is_null() );
+      BOOST_REQUIRE_EQUAL( printstate( empty )["0x01"].as_string(), "0x33" );
+
+      // Slots written and wiped in one transaction never reach the table
+      teststatetx( "f8600380830186a094c0de00000000000000000000000000000000004180801ca0349a674df19966e850faa3c8f74510334e48e660e82e1efe8a3031dd2003c598a06c7b8598290604325a98c33df753f517f7ff4c75dcc699ec427f5326d9477f7e" );
+      produce_blocks(1);
+      BOOST_REQUIRE_EQUAL( get_storage_generation(4), 1 );
+      BOOST_REQUIRE( get_stale_scope(4).is_null() );
+      BOOST_REQUIRE( get_state_row(4, 0).is_null() );
+      BOOST_REQUIRE( get_state_row((uint64_t(1) << 32) | 4, 0).is_null() );
+   } FC_LOG_AND_RETHROW()
+
+   // ecrecover reads missing input bytes as zero
+   BOOST_FIXTURE_TEST_CASE( ecrecover_short_input, eosio_evm_tester ) try {
+      // Calls ecrecover with the calldata, stores the output under calldata size
+      // and RETURNDATASIZE + 1 under 0x1000 | calldata size
+      const std::string contract = "c0de000000000000000000000000000000000050";
+      devnewacct( test_sender, test_balance );
+      devnewacct( contract, "0x00", "366000600037602061020036600060015afa506102005136553d60010136611000175500" );
+      produce_blocks(1);
+
+      // Signature of the test sender whose s ends in a zero byte, sent as 128, 127, 96 and 0 bytes
+      teststatetx( "f8e1808083030d4094c0de00000000000000000000000000000000005080b880f0419d3838e17c289b36892fe1565632dbfc7e51060b815b4aa0c8b76c30d5cc000000000000000000000000000000000000000000000000000000000000001cf8265e47ff72a69e655c33cbbc7ac2bcf296d0e3489584898f78124b354e9cb62889df711a8e744acb3d1ed88b54bdcc7439ec7fcb64d409ea1f59fc83316c001ba0c2f84987f0f323bca4d0210e14401c1c35ddd6e080ee7b97028c5e62fc4eb2a5a063cd8d98bd8e263eed14db113840c5a1ce663a072a37c53b38727de0541a3582" );
+      teststatetx( "f8e0018083030d4094c0de00000000000000000000000000000000005080b87ff0419d3838e17c289b36892fe1565632dbfc7e51060b815b4aa0c8b76c30d5cc000000000000000000000000000000000000000000000000000000000000001cf8265e47ff72a69e655c33cbbc7ac2bcf296d0e3489584898f78124b354e9cb62889df711a8e744acb3d1ed88b54bdcc7439ec7fcb64d409ea1f59fc83316c1ca0669623baaf6736afc660590ae0a457e8f3c2d4ac03887decf612bd5b42e8ad1ba050df7f288eb3a7179d5fe60cb27dffcf34390e1f6888fb2164211f8ee001ab25" );
+      teststatetx( "f8c1028083030d4094c0de00000000000000000000000000000000005080b860f0419d3838e17c289b36892fe1565632dbfc7e51060b815b4aa0c8b76c30d5cc000000000000000000000000000000000000000000000000000000000000001cf8265e47ff72a69e655c33cbbc7ac2bcf296d0e3489584898f78124b354e9cb61ba0529c4d46b2813cac657b66244079d87695904fb71013f2a68f403b11b95a367ca0069f7336335cc147b3db76ad9d1a4197ba77c939b373df68f0bb8637672adf2a" );
+      teststatetx( "f860038083030d4094c0de00000000000000000000000000000000005080801ba026b89cdbf5e549137fd6a1c8987985c3734be395fe9784dc70497d212d0043bda010b3cc60f40b40f0f72aee9830ec60e1aa6d670467d695bd8ae7e206918ef00a" );
+      produce_blocks(1);
+
+      auto state = printstate( contract );
+      BOOST_REQUIRE_EQUAL( state.size(), 6 );
+      BOOST_REQUIRE_EQUAL( state["0x80"].as_string(), "0x" + test_sender );
+      BOOST_REQUIRE_EQUAL( state["0x1080"].as_string(), "0x21" );
+      BOOST_REQUIRE_EQUAL( state["0x7f"].as_string(), "0x" + test_sender );
+      BOOST_REQUIRE_EQUAL( state["0x107f"].as_string(), "0x21" );
+
+      // Zero s is invalid, nothing is returned
+      BOOST_REQUIRE( !state.contains("0x60") );
+      BOOST_REQUIRE_EQUAL( state["0x1060"].as_string(), "0x01" );
+      BOOST_REQUIRE_EQUAL( state["0x1000"].as_string(), "0x01" );
+   } FC_LOG_AND_RETHROW()
+
+   // Memory expansion is charged on the total size and memory of a reused frame starts empty
+   BOOST_FIXTURE_TEST_CASE( memory_expansion, eosio_evm_tester ) try {
+      // Expands to 1, 129 and 513 words with MSTORE, MSTORE8 and MLOAD, storing MSIZE after each
+      const std::string expand = "c0de000000000000000000000000000000000070";
+      // Calls itself twice: the first call writes at 0x1000, the second stores
+      // MSIZE + 1, MLOAD(0x1000) + 1 and MSIZE after the load
+      const std::string reuse  = "c0de000000000000000000000000000000000071";
+      devnewacct( test_sender, test_balance );
+      devnewacct( expand, "0x00", "600160005259600155600161101f535960025561400051505960035500" );
+      devnewacct( reuse, "0x00", "3660011461002d57366002146100355760006000600160006000305af15060006000600260006000305af150005b60ff61100052005b59600101600455611000516001016005555960065500" );
+      produce_blocks(1);
+
+      // 21000 + 12 + 425 + 1642 + 3 * 20005, memory cost is 3 * words + words * words / 512
+      auto res = teststatetx( "f860808083030d4094c0de00000000000000000000000000000000007080801ba0f82e19352441d24bace2527c64c3601c53990cf9e584df35b94df1874db4633fa06339112ee8c42fd0feedf9cc2a91e9a067e537e31f92766ddc05120fd4de3aac" );
+      BOOST_REQUIRE( res->action_traces[0].console.find("\"gasUsed\": \"14496\"") != std::string::npos );
+      produce_blocks(1);
+      auto state = printstate( expand );
+      BOOST_REQUIRE_EQUAL( state["0x01"].as_string(), "0x20" );
+      BOOST_REQUIRE_EQUAL( state["0x02"].as_string(), "0x1020" );
+      BOOST_REQUIRE_EQUAL( state["0x03"].as_string(), "0x4020" );
+
+      teststatetx( "f860018083030d4094c0de00000000000000000000000000000000007180801ca096d325c77260991a5c7c0b616a18e5ebfd64d6ee6907ec48fc645dd359104d62a06e90752993f8446c2c18a48d9c5f6d495e06a10c8c516e6694651395ffd12607" );
+      produce_blocks(1);
+      state = printstate( reuse );
+      BOOST_REQUIRE_EQUAL( state["0x04"].as_string(), "0x01" );
+      BOOST_REQUIRE_EQUAL( state["0x05"].as_string(), "0x01" );
+      BOOST_REQUIRE_EQUAL( state["0x06"].as_string(), "0x1020" );
+   } FC_LOG_AND_RETHROW()
+
+   // ADD, SUB, MUL, LT, GT and EQ with operands on both sides of 2^64
+   BOOST_FIXTURE_TEST_CASE( arithmetic_limb_boundary, eosio_evm_tester ) try {
+      // Stores the result of case i under key i, zero results leave no slot
+      const std::string contract = "c0de000000000000000000000000000000000080";
+      devnewacct( test_sender, test_balance );
+      devnewacct( contract, "0x00", "600167ffffffffffffffff016001556001680100000000000000000360025560016000036003556401000000006401000000000260045567ffffffffffffffff67ffffffffffffffff0260055560027fffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffff016006556002678000000000000000026007556801000000000000000068010000000000000000016008556801000000000000000068010000000000000001036009556801000000000000000067ffffffffffffffff03600a5578010000000000000000000000000000000000000000000000006801000000000000000002600b556801000000000000000167ffffffffffffffff02600c5567ffffffffffffffff6801000000000000000011600d556801000000000000000067ffffffffffffffff10600e5567ffffffffffffffff6801000000000000000010600f5570010000000000000000000000000000000060011160105567ffffffffffffffff67ffffffffffffffff10601155600068010000000000000000146012556801000000000000000568010000000000000005146013556801000000000000000560051460145500" );
+      produce_blocks(1);
+
+      teststatetx( "f8608080831e848094c0de00000000000000000000000000000000008080801ba03972b5ef6c7d4dd42d428da82ddc87806c5b3b3fd2dec81fd591cda5b1a6db38a07bdc3a1b31f176060b41d8d7ec251dab19b11dfef21d8adf39f45ac05eea5064" );
+      produce_blocks(1);
+
+      const std::vector<std::pair<std::string, std::string>> expected = {
+         { "0x01", "0x010000000000000000" },                                                 // 2^64 - 1 + 1
+         { "0x02", "0xffffffffffffffff" },                                                   // 2^64 - 1
+         { "0x03", "0xffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffff" },   // 0 - 1
+         { "0x04", "0x010000000000000000" },                                                 // 2^32 * 2^32
+         { "0x05", "0xfffffffffffffffe0000000000000001" },                                   // (2^64 - 1)^2
+         { "0x06", "0x01" },                                                                 // 2^256 - 1 + 2
+         { "0x07", "0x010000000000000000" },                                                 // 2^63 * 2
+         { "0x08", "0x020000000000000000" },                                                 // 2^64 + 2^64
+         { "0x09", "0x01" },                                                                 // 2^64 + 1 - 2^64
+         { "0x0a", "0xffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffff" },   // 2^64 - 1 - 2^64
+         { "0x0b", "" },                                                                     // 2^64 * 2^192
+         { "0x0c", "0xffffffffffffffffffffffffffffffff" },                                   // (2^64 - 1) * (2^64 + 1)
+         { "0x0d", "0x01" },                                                                 // 2^64 > 2^64 - 1
+         { "0x0e", "0x01" },                                                                 // 2^64 - 1 < 2^64
+         { "0x0f", "" },                                                                     // 2^64 < 2^64 - 1
+         { "0x10", "" },                                                                     // 1 > 2^128
+         { "0x11", "" },                                                                     // 2^64 - 1 < 2^64 - 1
+         { "0x12", "" },                                                                     // 2^64 == 0
+         { "0x13", "0x01" },                                                                 // 2^64 + 5 == 2^64 + 5
+         { "0x14", "" },                                                                     // 5 == 2^64 + 5
+      };
+
+      auto state = printstate( contract );
+      BOOST_REQUIRE_EQUAL( state.size(), 14 );
+      for (const auto& [key, value] : expected) {
+         if (value.empty()) {
+            BOOST_REQUIRE( !state.contains(key) );
+         } else {
+            BOOST_REQUIRE_EQUAL( state[key].as_string(), value );
+         }
+      }
+   } FC_LOG_AND_RETHROW()
+
+   // EXP with power of two bases, trivial exponents and exponents wider than a limb
+   BOOST_FIXTURE_TEST_CASE( exp_cases, eosio_evm_tester ) try {
+      // Stores the result of case i under key i, results expected to be zero are stored through ISZERO
+      const std::string contract = "c0de000000000000000000000000000000000090";
+      devnewacct( test_sender, test_balance );
+      devnewacct( contract, "0x00", "600060020a600155600160020a60025560ff60020a60035561010060020a15600455606460040a6005556003680100000000000000000a6006556004680100000000000000000a156007556801000000000000000160030a60085567ffffffffffffffff60030a600955600060000a600a55600560000a15600b557f800000000000000000000000000000000000000000000000000000000000000060010a600c5560017f80000000000000000000000000000000000000000000000000000000000000000a600d5579010000000000000000000000000000000000000000000000000060020a15600e557001000000000000000000000000000000037fffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffff0a600f55600060030a601055600160030a6011557fffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffff60070a6012557004000000000000000000000000000000ff63012345670a60135500" );
+      produce_blocks(1);
+
+      // EXP costs 10 + 50 per byte of exponent
+      auto res = teststatetx( "f8608080831e848094c0de00000000000000000000000000000000009080801ba00feedaf196c78a1a112b43bc9fae672ab9db21e4e9bf40074e6647517067a258a060b14fbb276724e3d2a8b2e5c13814525617bad4e66c3ce7ada847bc66e0a77c" );
+      BOOST_REQUIRE( res->action_traces[0].console.find("\"gasUsed\": \"63d5b\"") != std::string::npos );
+      produce_blocks(1);
+
+      const std::vector<std::pair<std::string, std::string>> expected = {
+         { "0x01", "0x01" },                                                                 // 2^0
+         { "0x02", "0x02" },                                                                 // 2^1
+         { "0x03", "0x8000000000000000000000000000000000000000000000000000000000000000" },   // 2^255
+         { "0x04", "0x01" },                                                                 // 2^256 is zero
+         { "0x05", "0x0100000000000000000000000000000000000000000000000000" },               // 4^100
+         { "0x06", "0x01000000000000000000000000000000000000000000000000" },                 // (2^64)^3
+         { "0x07", "0x01" },                                                                 // (2^64)^4 is zero
+         { "0x08", "0x48cae9d381443195844e5bfa6e308f6c005670a967b8badc0000000000000003" },   // 3^(2^64 + 1)
+         { "0x09", "0xeba4c4a5b90793bb4796edc67e056544e397d3a10b864da6aaaaaaaaaaaaaaab" },   // 3^(2^64 - 1)
+         { "0x0a", "0x01" },                                                                 // 0^0
+         { "0x0b", "0x01" },                                                                 // 0^5 is zero
+         { "0x0c", "0x01" },                                                                 // 1^(2^255)
+         { "0x0d", "0x8000000000000000000000000000000000000000000000000000000000000000" },   // (2^255)^1
+         { "0x0e", "0x01" },                                                                 // 2^(2^200) is zero
+         { "0x0f", "0xffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffff" },   // (2^256 - 1)^(2^128 + 3)
+         { "0x10", "0x01" },                                                                 // 3^0
+         { "0x11", "0x03" },                                                                 // 3^1
+         { "0x12", "0x6db6db6db6db6db6db6db6db6db6db6db6db6db6db6db6db6db6db6db6db6db7" },   // 7^(2^256 - 1)
+         { "0x13", "0x657433a7d86bc22e3dfbff036a7161e131a987812ffe90b70848cf93df3ace57" },   // 0x1234567^(2^130 + 0xff)
+      };
+
+      auto state = printstate( contract );
+      BOOST_REQUIRE_EQUAL( state.size(), expected.size() );
+      for (const auto& [key, value] : expected) {
+         BOOST_REQUIRE_EQUAL( state[key].as_string(), value );
+      }
+   } FC_LOG_AND_RETHROW()
+
+   // Transactions of a batch run in order, a failed execution only reverts itself
+   BOOST_FIXTURE_TEST_CASE( rawbatch, eosio_evm_tester ) try {
+      const std::string counter = "c0de0000000000000000000000000000000000b0"; // Increments slot 0
+      const std::string reverts = "c0de0000000000000000000000000000000000b1"; // REVERT
+      devnewacct( test_sender, test_balance );
+      devnewacct( counter, "0x00", "60005460010160005500" );
+      devnewacct( reverts, "0x00", "600080fd" );
+      produce_blocks(1);
+
+      // Signed calls from the test sender by nonce, nonce 1 calls the reverting contract
+      const std::vector<std::string> txs = {
+         "f8608080830186a094c0de0000000000000000000000000000000000b080801ba04526b13cf13bfb15d3ce2b09be0cabb550d775531896e551711a02e7a4766f97a027a8c80935bd877c2e600f2e2119e22ebe6009e139bc8e3b039f47bd53c3d560",
+         "f8600180830186a094c0de0000000000000000000000000000000000b180801ba0d96035bb5dbd7aecdfb93727c7aeb34681977e6144224507b2c958570ad84612a00ecc1a6c92a3d59572cb1acead66bb864e42980ed8e4f55e7836f89617ab32c5",
+         "f8600280830186a094c0de0000000000000000000000000000000000b080801ca0e81d4986109d19b73576bf0f4fe847aae802c26c9111febc60c22e43ee890deaa00d3e4a099c3a1b85cf35120ad59f0da47d07340126c54cd8abb4452aa5027a25",
+         "f8600380830186a094c0de0000000000000000000000000000000000b080801ca011126313ba97b0344ea869bcc413aaa4f698d4c4719b43df97da61e2e4c6de43a0652131e9acc5824dfdaa89af903055e1cc250e6ffa5d9a01adb308c568963fe3",
+         "f8600480830186a094c0de0000000000000000000000000000000000b080801ba098a477a42ee233d45f3cf136d4c49243f32015b5cfa7a7f91c6382f08d4c7cd2a0196e8b1622a369340ea81cdb7bd30cab867060d7581d2f3c4893a9420086912e",
+         "f8600580830186a094c0de0000000000000000000000000000000000b080801ba02f4adaaf35d299ef55e1f333c3352d7907e6a4107082ab5c0c785bab756f373ca0319f439ae13207f27b456429f65b99fe5b66f3fb6b17bbd31d9fa06be399828b",
+      };
+      const std::string unsigned_tx = "e00380830186a094c0de0000000000000000000000000000000000b08080808080";
+
+      // Reverted transaction in the middle, gas is 41812, 21006 and 26812
+      auto res = rawbatch( { txs[0], txs[1], txs[2] } );
+      auto receipts = fc::json::from_string(res->action_traces[0].console).get_array();
+      BOOST_REQUIRE_EQUAL( receipts.size(), 3 );
+      const std::vector<std::tuple<std::string, std::string, std::string>> expected = {
+         { "1", "a354", "a354" },
+         { "0", "520e", "f562" },
+         { "1", "68bc", "15e1e" },
+      };
+      for (size_t i = 0; i < receipts.size(); i++) {
+         const auto& [status, gas_used, cumulative_gas_used] = expected[i];
+         BOOST_REQUIRE_EQUAL( receipts[i]["status"].as_string(), status );
+         BOOST_REQUIRE_EQUAL( receipts[i]["gasUsed"].as_string(), gas_used );
+         BOOST_REQUIRE_EQUAL( receipts[i]["cumulativeGasUsed"].as_string(), cumulative_gas_used );
+         BOOST_REQUIRE_EQUAL( receipts[i]["transactionIndex"].as_string(), std::to_string(i) );
+      }
+      produce_blocks(1);
+      BOOST_REQUIRE_EQUAL( printstate( counter )["0x00"].as_string(), "0x02" );
+      BOOST_REQUIRE_EQUAL( printaccount( test_sender )["nonce"].as_string(), "0x03" );
+
+      // A nonce gap or a nonce out of order fails the whole batch
+      BOOST_CHECK_EXCEPTION(
+         rawbatch( { txs[3], txs[5] } ),
+         eosio_assert_message_exception,
+         [](const eosio_assert_message_exception& e) {
+            return expect_assert_message(e, "Invalid Transaction: incorrect nonce, received 5 expected 4");
+         }
+      );
+      BOOST_CHECK_EXCEPTION(
+         rawbatch( { txs[4], txs[3] } ),
+         eosio_assert_message_exception,
+         [](const eosio_assert_message_exception& e) {
+            return expect_assert_message(e, "Invalid Transaction: incorrect nonce, received 4 expected 3");
+         }
+      );
+
+      // Unsigned transactions have no sender
+      BOOST_CHECK_EXCEPTION(
+         rawbatch( { txs[3], unsigned_tx } ),
+         eosio_assert_message_exception,
+         [](const eosio_assert_message_exception& e) {
+            return expect_assert_message(e, "Invalid Batch: transactions must be signed.");
+         }
+      );
+      produce_blocks(1);
+      BOOST_REQUIRE_EQUAL( printstate( counter )["0x00"].as_string(), "0x02" );
+      BOOST_REQUIRE_EQUAL( printaccount( test_sender )["nonce"].as_string(), "0x03" );
+
+      rawbatch( { txs[3], txs[4] } );
+      produce_blocks(1);
+      BOOST_REQUIRE_EQUAL( printstate( counter )["0x00"].as_string(), "0x04" );
+      BOOST_REQUIRE_EQUAL( printaccount( test_sender )["nonce"].as_string(), "0x05" );
+   } FC_LOG_AND_RETHROW()
+
+   // SHA3 of inputs around the 136 byte keccak rate and of the one and two word fast paths
+   BOOST_FIXTURE_TEST_CASE( keccak_rate_boundary, eosio_evm_tester ) try {
+      // Copies calldata to memory and stores SHA3 of its first n bytes under key n,
+      // and SHA3 of 136 bytes at offset 1 under key 0x1000
+      const std::string contract = "c0de0000000000000000000000000000000000a0";
+      devnewacct( test_sender, test_balance );
+      devnewacct( contract, "0x00", "36600060003760006000206000556020600020602055604060002060405560876000206087556088600020608855608960002060895561010f60002061010f55610110600020610110556101116000206101115560886001206110005500" );
+      produce_blocks(1);
+
+      // Calldata is 300 bytes, byte i is (7 * i + 3) mod 256
+      teststatetx( "f9018e8080831e848094c0de0000000000000000000000000000000000a080b9012c030a11181f262d343b424950575e656c737a81888f969da4abb2b9c0c7ced5dce3eaf1f8ff060d141b222930373e454c535a61686f767d848b9299a0a7aeb5bcc3cad1d8dfe6edf4fb020910171e252c333a41484f565d646b727980878e959ca3aab1b8bfc6cdd4dbe2e9f0f7fe050c131a21282f363d444b525960676e757c838a91989fa6adb4bbc2c9d0d7dee5ecf3fa01080f161d242b323940474e555c636a71787f868d949ba2a9b0b7bec5ccd3dae1e8eff6fd040b121920272e353c434a51585f666d747b828990979ea5acb3bac1c8cfd6dde4ebf2f900070e151c232a31383f464d545b626970777e858c939aa1a8afb6bdc4cbd2d9e0e7eef5fc030a11181f262d343b424950575e656c737a81888f969da4abb2b9c0c7ced5dce3eaf1f8ff060d141b2229301ca00d26ef422427e7abcca3fbfc92227ab4bda207740f604ecbdb0759b5180a1fb0a0700f94b3d3b389046f19e2500bc62d70ee2fc5883c3004cfafb3c51f49dc149a" );
+      produce_blocks(1);
+
+      const std::vector<std::pair<std::string, std::string>> expected = {
+         { "0x00", "0xc5d2460186f7233c927e7db2dcc703c0e500b653ca82273b7bfad8045d85a470" },
+         { "0x20", "0x04d1b47ed3b04c5ff6a0280293cb2ab55bd297c9c2e0c3449831b419285d7df2" },
+         { "0x40", "0x0251cf13aa5b18f1cbda7cddbe85f3dc536fc93df590c2d20ca9b28af1ed2c39" },
+         { "0x87", "0xef96af9cf4b24c7f269d922294444a197d0a33638c2e56634c57e892103a8f" },
+         { "0x88", "0x742061bcad767ed4c4f5883b1dcb1aad11afdcc140dc469d953759b127b9f9ed" },
+         { "0x89", "0xe3371f61e770abf254c34239c3b0099ad90594507415bc81dd0a10b9692bbf2a" },
+         { "0x010f", "0x4401c4afbe16ff911bdbf2d38e556e5b861f3fdf0f9d4306b1c46f6ae4f73584" },
+         { "0x0110", "0xac141fd7b0a0ffcd2e967254d508da3ec616596493c36fa304425647d90e6de5" },
+         { "0x0111", "0x16192ea86793083e47731cb3c970600f04768414d92bc0540e54ce8607a0fce0" },
+         { "0x1000", "0x30983d681a6ab778613e94dcbe7a7bd2ece2f6f5e8658ffaa6cd7940c805a7c6" },
+      };
+
+      auto state = printstate( contract );
+      BOOST_REQUIRE_EQUAL( state.size(), expected.size() );
+      for (const auto& [key, value] : expected) {
+         BOOST_REQUIRE_EQUAL( state[key].as_string(), value );
+      }
+   } FC_LOG_AND_RETHROW()
+
+   // Length prefixes over 4 bytes or past the end of the input are rejected
+   BOOST_FIXTURE_TEST_CASE( rlp_malformed_length, eosio_evm_tester ) try {
+      // 64 byte data field with the 8 byte length 0x0100000000000040, which wraps to 64 in 32 bits
+      // a 4 byte length with a leading zero byte, and a 3 byte length past the end of the input
+      const std::vector<std::string> txs = {
+         "f8688080830186a094c0de0000000000000000000000000000000000c080bf0100000000000040000102030405060708090a0b0c0d0e0f101112131415161718191a1b1c1d1e1f202122232425262728292a2b2c2d2e2f303132333435363738393a3b3c3d3e3f1b0101",
+         "f8648080830186a094c0de0000000000000000000000000000000000c080bb00000040000102030405060708090a0b0c0d0e0f101112131415161718191a1b1c1d1e1f202122232425262728292a2b2c2d2e2f303132333435363738393a3b3c3d3e3f1b0101",
+         "f8638080830186a094c0de0000000000000000000000000000000000c080ba010000000102030405060708090a0b0c0d0e0f101112131415161718191a1b1c1d1e1f202122232425262728292a2b2c2d2e2f303132333435363738393a3b3c3d3e3f1b0101",
+      };
+      for (const auto& tx : txs) {
+         BOOST_CHECK_EXCEPTION(
+            teststatetx( tx ),
+            eosio_assert_message_exception,
+            [](const eosio_assert_message_exception& e) {
+               return expect_assert_message(e, "Invalid Transaction: RLP could not be decoded");
+            }
+         );
+      }
+   } FC_LOG_AND_RETHROW()
+
+   // Repeated 64 byte SHA3 inputs are answered from the memo, colliding inputs evict each other
+   BOOST_FIXTURE_TEST_CASE( sha3_memo_collision, eosio_evm_tester ) try {
+      // Copies 128 bytes of calldata to memory and stores SHA3 of
+      // bytes 0..64, 0..64, 64..128, 0..64, 64..128 under keys 0 to 4
+      const std::string contract = "c0de0000000000000000000000000000000000d0";
+      devnewacct( test_sender, test_balance );
+      devnewacct( contract, "0x00", "608060006000376040600020600055604060002060015560406040206002556040600020600355604060402060045500" );
+      produce_blocks(1);
+
+      // Calldata is the mapping slot inputs of keys 1 and 0x4e at slot 0, which share a memo index
+      teststatetx( "f8e18080830f424094c0de0000000000000000000000000000000000d080b88000000000000000000000000000000000000000000000000000000000000000010000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000004e00000000000000000000000000000000000000000000000000000000000000001ba0cdd1c6ca9d2accb58bb90b062298efe177d0a2cdaaed47011128e6f2cfaa2e0ca006f47a8392186ae407abf575940f89fabd8f4128cfe5afd22d6eaa438e69807f" );
+      produce_blocks(1);
+
+      const std::vector<std::pair<std::string, std::string>> expected = {
+         { "0x00", "0xada5013122d395ba3c54772283fb069b10426056ef8ca54750cb9bb552a59e7d" },
+         { "0x01", "0xada5013122d395ba3c54772283fb069b10426056ef8ca54750cb9bb552a59e7d" },
+         { "0x02", "0xbc1b1bcc71127fe45b676f9e483b926bd80482bed59dc990c5f13506110621ee" },
+         { "0x03", "0xada5013122d395ba3c54772283fb069b10426056ef8ca54750cb9bb552a59e7d" },
+         { "0x04", "0xbc1b1bcc71127fe45b676f9e483b926bd80482bed59dc990c5f13506110621ee" },
+      };
+
+      auto state = printstate( contract );
+      BOOST_REQUIRE_EQUAL( state.size(), expected.size() );
+      for (const auto& [key, value] : expected) {
+         BOOST_REQUIRE_EQUAL( state[key].as_string(), value );
+      }
+   } FC_LOG_AND_RETHROW()
+BOOST_AUTO_TEST_SUITE_END()
+
 BOOST_AUTO_TEST_SUITE(eosio_evm_erc20, * boost::unit_test::enable_if<erc20_enabled>())
    BOOST_FIXTURE_TEST_CASE( erc_20, eosio_evm_tester ) try {
       // Create new address